@@ -0,0 +1,59 @@
+#ifndef ARGUMENTS_H
+#define ARGUMENTS_H
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
+
+// Numeric command-line values shared by the drivers. The whole argument has
+// to be the number: empty strings, trailing characters, out of range values
+// and, for unsigned options, a sign are rejected instead of read as 0 or
+// wrapped. Floating-point values must be finite.
+namespace arguments
+{
+    template <typename T>
+    bool parse(const char *text, T &value)
+    {
+        static_assert(std::is_arithmetic_v<T>, "numeric options only");
+
+        errno = 0;
+        char *end = nullptr;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            const double parsed = std::strtod(text, &end);
+            if (end == text || errno == ERANGE || *end != '\0' || !std::isfinite(parsed))
+            {
+                return false;
+            }
+            value = static_cast<T>(parsed);
+        }
+        else if constexpr (std::is_unsigned_v<T>)
+        {
+            // strtoull would accept "-1" and wrap it
+            if (*text < '0' || *text > '9')
+            {
+                return false;
+            }
+            const unsigned long long parsed = std::strtoull(text, &end, 10);
+            if (errno == ERANGE || *end != '\0' || parsed > std::numeric_limits<T>::max())
+            {
+                return false;
+            }
+            value = static_cast<T>(parsed);
+        }
+        else
+        {
+            const long long parsed = std::strtoll(text, &end, 10);
+            if (end == text || errno == ERANGE || *end != '\0' || parsed < std::numeric_limits<T>::min() || parsed > std::numeric_limits<T>::max())
+            {
+                return false;
+            }
+            value = static_cast<T>(parsed);
+        }
+        return true;
+    }
+}
+
+#endif // ARGUMENTS_H
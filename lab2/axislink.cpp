@@ -0,0 +1,38 @@
+#include "axislink.h"
+
+AxisLink::AxisLink(const std::vector<QCustomPlot *> &plots, QObject *parent)
+    : QObject(parent)
+    , plots(plots)
+{
+    for (QCustomPlot *plot : plots)
+    {
+        connect(plot->xAxis, qOverload<const QCPRange &>(&QCPAxis::rangeChanged), this, &AxisLink::onRangeChanged);
+    }
+}
+
+void AxisLink::onRangeChanged(const QCPRange &range)
+{
+    if (propagating)
+    {
+        return;
+    }
+
+    propagating = true;
+    const QCPAxis *source = qobject_cast<const QCPAxis *>(sender());
+    for (QCustomPlot *plot : plots)
+    {
+        if (plot->xAxis == source)
+        {
+            continue;
+        }
+
+        // setRange() ignores an unchanged range, so nothing is redrawn for it
+        const QCPRange before = plot->xAxis->range();
+        plot->xAxis->setRange(range);
+        if (plot->xAxis->range() != before)
+        {
+            plot->replot(QCustomPlot::rpQueuedReplot);
+        }
+    }
+    propagating = false;
+}
@@ -0,0 +1,32 @@
+#ifndef AXISLINK_H
+#define AXISLINK_H
+
+#include <QObject>
+#include "qcustomplot.h"
+
+#include <vector>
+
+// Keeps the key axes of several plots on the same range. A drag or zoom on
+// one plot is copied to the others once, and every plot that changed gets a
+// queued replot, so one interaction costs one frame on each widget. Graphs
+// only process the points inside the new range (plus the LOD pyramid), so
+// the followers do not touch the rest of the data.
+class AxisLink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AxisLink(const std::vector<QCustomPlot *> &plots, QObject *parent = nullptr);
+
+private slots:
+    void onRangeChanged(const QCPRange &range);
+
+private:
+    std::vector<QCustomPlot *> plots;
+
+    // Set while the new range is copied, so the followers' own rangeChanged
+    // signals are not propagated back
+    bool propagating = false;
+};
+
+#endif // AXISLINK_H
@@ -0,0 +1,150 @@
+#ifndef BATCHKALMAN_H
+#define BATCHKALMAN_H
+
+#include "kalman.h"
+#include "simd.h"
+#include "trajectory.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+// Runs several filters that share F, H and the measurement stream but differ
+// in initial covariance, Q or R. Filters are packed into SIMD lanes
+// (structure of arrays: one pack per matrix element), so a single pass over z
+// advances simd::Pack::width of them at once.
+template <std::size_t N>
+class BatchKalman
+{
+public:
+    using Pack = simd::Pack;
+
+    struct Variant
+    {
+        kalman::Matrix<N, N> p0;
+        kalman::Matrix<N, N> Q;
+        double R;
+    };
+
+    BatchKalman(const kalman::Matrix<N, N> &F, const kalman::Matrix<1, N> &H) : F(F), H(H) {}
+
+    // Filters z with every variant, estimates[i] receives the output of variants[i]
+    void run(const std::vector<Variant> &variants, const Trajectory<1> &z, std::vector<Trajectory<N>> &estimates) const
+    {
+        estimates.assign(variants.size(), Trajectory<N>(z.size()));
+        advance(variants, z, [&](std::size_t first, std::size_t lanes, std::size_t step, const kalman::Vector<N, Pack> &x)
+        {
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                double values[Pack::width];
+                x[k].store(values);
+                for (std::size_t lane = 0; lane < lanes; ++lane)
+                {
+                    estimates[first + lane](k, step) = values[lane];
+                }
+            }
+        });
+    }
+
+    // Mean squared error against the true states for every variant:
+    // summary over all components first, then each component
+    std::vector<std::array<double, N + 1>> errors(const std::vector<Variant> &variants, const Trajectory<1> &z, const Trajectory<N> &truth) const
+    {
+        std::vector<std::array<double, N + 1>> result(variants.size());
+        const Pack horizon(static_cast<double>(z.size() - 1));
+
+        std::array<Pack, N + 1> err;
+        advance(variants, z, [&](std::size_t first, std::size_t lanes, std::size_t step, const kalman::Vector<N, Pack> &x)
+        {
+            if (step == 1)
+            {
+                err.fill(Pack(0.));
+            }
+
+            std::array<Pack, N> sq;
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                const Pack d = Pack(truth(k, step)) - x[k];
+                sq[k] = d * d;
+            }
+
+            Pack sum = sq[0];
+            for (std::size_t k = 1; k < N; ++k)
+            {
+                sum += sq[k];
+            }
+            err[0] += sum / horizon;
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                err[k + 1] += sq[k] / horizon;
+            }
+
+            if (step + 1 == z.size())
+            {
+                for (std::size_t k = 0; k < N + 1; ++k)
+                {
+                    double values[Pack::width];
+                    err[k].store(values);
+                    for (std::size_t lane = 0; lane < lanes; ++lane)
+                    {
+                        result[first + lane][k] = values[lane];
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+private:
+    const kalman::Matrix<N, N> F;
+    const kalman::Matrix<1, N> H;
+
+    // Packs one block of variants into lanes and runs it over the whole
+    // stream. observe(first, lanes, step, x) sees the estimate after each
+    // update, steps 1 .. n - 1. Unused trailing lanes repeat the last variant.
+    template <typename Observer>
+    void advance(const std::vector<Variant> &variants, const Trajectory<1> &z, Observer &&observe) const
+    {
+        for (std::size_t first = 0; first < variants.size(); first += Pack::width)
+        {
+            const std::size_t lanes = std::min(Pack::width, variants.size() - first);
+            const auto lane = [&](std::size_t i) -> const Variant & { return variants[first + std::min(i, lanes - 1)]; };
+
+            kalman::Model<N, 1, Pack> model;
+            kalman::State<N, Pack> state;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    double q[Pack::width];
+                    double p[Pack::width];
+                    for (std::size_t l = 0; l < Pack::width; ++l)
+                    {
+                        q[l] = lane(l).Q(i, j);
+                        p[l] = lane(l).p0(i, j);
+                    }
+                    model.F(i, j) = Pack(F(i, j));
+                    model.Q(i, j) = Pack::load(q);
+                    state.p(i, j) = Pack::load(p);
+                }
+                model.H(0, i) = Pack(H(0, i));
+            }
+
+            double r[Pack::width];
+            for (std::size_t l = 0; l < Pack::width; ++l)
+            {
+                r[l] = lane(l).R;
+            }
+            model.R(0, 0) = Pack::load(r);
+
+            for (std::size_t step = 1; step < z.size(); ++step)
+            {
+                kalman::predict(model, state);
+                kalman::update(model, state, kalman::Vector<1, Pack>{ { Pack(z(0, step)) } });
+                observe(first, lanes, step, state.x);
+            }
+        }
+    }
+};
+
+#endif // BATCHKALMAN_H
@@ -0,0 +1,103 @@
+#include "solution.h"
+#include "batchkalman.h"
+#include "batchstrapdown.h"
+
+#include <chrono>
+
+namespace
+{
+    constexpr int steps = 100'000;
+
+    template <typename Step>
+    double nanosecondsPerStep(Step step)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < steps; ++i)
+        {
+            step();
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count() / steps;
+    }
+}
+
+// Per-step cost of the Kalman predict/update: NdArray path vs fixed-size kernel
+int main()
+{
+    const nc::NdArray<double> A = { {0, -constants::g, 0}, {1 / constants::R, 0, 1}, {0, 0, 0} };
+    const nc::NdArray<double> F = static_cast<double>(constants::T) * A + nc::eye<double>(nc::Shape{ 3, 3 });
+    const nc::NdArray<double> H = { 1, 0, 0 };
+    const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
+    const nc::NdArray<double> Q = 1e-15 * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
+    const double R = 1.;
+    const double z = 0.5;
+
+    nc::NdArray<double> p = I;
+    nc::NdArray<double> x = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
+    const double ndarray_ns = nanosecondsPerStep([&]()
+    {
+        const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
+        const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
+        x = nc::dot(F, x) + K * (z - nc::dot(nc::dot(H, F), x));
+        p = nc::dot((I - nc::dot(K, H)), P);
+    });
+
+    kalman::Model<3, 1> model;
+    for (nc::uint32 i = 0; i < 3; ++i)
+    {
+        for (nc::uint32 j = 0; j < 3; ++j)
+        {
+            model.F(i, j) = F(i, j);
+        }
+    }
+    model.H(0, 0) = 1.;
+    model.Q(2, 2) = 1e-15;
+    model.R(0, 0) = R;
+
+    kalman::State<3> state { {}, kalman::Matrix<3, 3>::identity() };
+    const double kernel_ns = nanosecondsPerStep([&]()
+    {
+        kalman::predict(model, state);
+        kalman::update(model, state, kalman::Vector<1>{ { z } });
+    });
+
+    // Same step for a batch of filters packed into SIMD lanes, cost per filter
+    const std::vector<BatchKalman<3>::Variant> variants(8, { kalman::Matrix<3, 3>::identity(), model.Q, R });
+    Trajectory<1> z_stream(steps);
+    for (int i = 0; i < steps; ++i)
+    {
+        z_stream(0, i) = z;
+    }
+    std::vector<Trajectory<3>> estimates;
+    const auto start = std::chrono::steady_clock::now();
+    BatchKalman<3>(model.F, model.H).run(variants, z_stream, estimates);
+    const auto stop = std::chrono::steady_clock::now();
+    const double batch_ns = std::chrono::duration<double, std::nano>(stop - start).count() / steps / variants.size();
+
+    // Strapdown cycle of hw/main.Rmd: one trajectory vs a lane-width batch
+    const strapdown::Scenario scenario;
+    strapdown::Engine<> engine(scenario.config());
+    const double engine_ns = nanosecondsPerStep([&]()
+    {
+        engine.step(scenario.sample(engine.steps(), engine.bodyToNavigation()));
+    });
+
+    BatchStrapdown<> trajectories(scenario, std::vector<StrapdownVariant>(simd::Pack::width));
+    const auto strapdown_start = std::chrono::steady_clock::now();
+    trajectories.run(steps);
+    const auto strapdown_stop = std::chrono::steady_clock::now();
+    const double trajectories_ns = std::chrono::duration<double, std::nano>(strapdown_stop - strapdown_start).count() / steps / trajectories.size();
+
+    // Keep the results observable so the loops are not optimized away
+    std::cout << "Final estimates: " << x(2, 0) << " / " << state.x[2] << " / " << estimates[0](2, steps - 1) << std::endl;
+    std::cout << "Final headings: " << engine.navigation().heading << " / " << trajectories.navigation(0).heading << std::endl;
+    std::cout << "NdArray path: " << ndarray_ns << " ns/step" << std::endl;
+    std::cout << "Fixed-size kernel: " << kernel_ns << " ns/step" << std::endl;
+    std::cout << "Batched kernel (" << simd::Pack::width << " lanes): " << batch_ns << " ns/step per filter" << std::endl;
+    std::cout << "Speedup: " << ndarray_ns / kernel_ns << "x, batched " << ndarray_ns / batch_ns << "x" << std::endl;
+    std::cout << "Strapdown engine: " << engine_ns << " ns/step" << std::endl;
+    std::cout << "Batched strapdown (" << simd::Pack::width << " lanes): " << trajectories_ns << " ns/step per trajectory, "
+              << engine_ns / trajectories_ns << "x" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "arguments.h"
+#include "solution.h"
+#include "ensemble.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct Options
+    {
+        std::uint64_t seed = 0;
+        std::size_t runs = 0;
+        SolutionSettings settings;
+        std::string output = "solution.csv";
+    };
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--seed N] [--q-min P] [--q-max P] [--q-points N] [--q-refine N] [--smoother-buffer DIR | --smoother-checkpoints] [--runs N] [--output FILE]" << std::endl
+                  << "  --seed N       noise stream seed (default 0)" << std::endl
+                  << "  --q-min P      Q sweep grid starts at 10^P (default -20)" << std::endl
+                  << "  --q-max P      Q sweep grid ends at 10^P (default -1)" << std::endl
+                  << "  --q-points N   grid points per level (default 20)" << std::endl
+                  << "  --q-refine N   levels, each zooming into the best q of the previous (default 1)" << std::endl
+                  << "  --smoother-buffer DIR" << std::endl
+                  << "                 keep the smoother forward pass in a temporary file in DIR, not in memory" << std::endl
+                  << "  --smoother-checkpoints" << std::endl
+                  << "                 keep about sqrt(n) smoother checkpoints and recompute the rest" << std::endl
+                  << "  --runs N       Monte Carlo ensemble of N realisations instead of a single run" << std::endl
+                  << "  --output FILE  CSV file to write (default solution.csv)" << std::endl;
+    }
+
+    bool parseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const bool has_value = i + 1 < argc;
+            if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.seed))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--q-min") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.settings.q_power_min))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--q-max") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.settings.q_power_max))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--q-points") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.settings.q_points))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--q-refine") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.settings.q_refine_levels))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--smoother-buffer") == 0 && has_value)
+            {
+                options.settings.smoother_buffer = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--smoother-checkpoints") == 0)
+            {
+                options.settings.smoother_checkpoints = true;
+            }
+            else if (std::strcmp(argv[i], "--runs") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.runs))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--output") == 0 && has_value)
+            {
+                options.output = argv[++i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        const SolutionSettings &settings = options.settings;
+        return settings.q_power_min <= settings.q_power_max && settings.q_points > 0 && settings.q_refine_levels > 0
+            && (settings.smoother_buffer.empty() || !settings.smoother_checkpoints);
+    }
+
+    // One row per step: time, true errors, measurement and every filter estimate
+    void writeSolution(const Solution &solution, std::ostream &out)
+    {
+        const std::array<std::pair<const char *, const Trajectory<3> *>, 12> estimates = { {
+            { "x", &solution.x },
+            { "x_err", &solution.x_err },
+            { "x_err_pmin", &solution.x_err_pmin },
+            { "x_err_pmax", &solution.x_err_pmax },
+            { "x_err_rmin", &solution.x_err_rmin },
+            { "x_err_rmax", &solution.x_err_rmax },
+            { "x_err_qmin", &solution.x_err_qmin },
+            { "x_err_qmax", &solution.x_err_qmax },
+            { "x_err_steady", &solution.x_err_steady },
+            { "x_err_smooth", &solution.x_err_smooth },
+            { "x_err_long", &solution.x_err_long },
+            { "x_err_short", &solution.x_err_short },
+        } };
+
+        out << "t,z";
+        for (const auto &estimate : estimates)
+        {
+            out << "," << estimate.first << "_speed," << estimate.first << "_angle," << estimate.first << "_drift";
+        }
+        out << "\n";
+
+        for (nc::uint32 i = 0; i < solution.n; ++i)
+        {
+            out << solution.t[i] << "," << solution.z(0, i);
+            for (const auto &estimate : estimates)
+            {
+                for (std::size_t k = 0; k < 3; ++k)
+                {
+                    out << "," << (*estimate.second)(k, i);
+                }
+            }
+            out << "\n";
+        }
+    }
+
+    // Per-step mean and standard deviation of the default filter error
+    void writeStatistics(const Ensemble::Statistics &stats, std::ostream &out)
+    {
+        out << "step,mean_speed,mean_angle,mean_drift,stddev_speed,stddev_angle,stddev_drift\n";
+        for (std::size_t i = 0; i < stats.mean.size(); ++i)
+        {
+            out << i * constants::T;
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                out << "," << stats.mean(k, i);
+            }
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                out << "," << stats.stddev(k, i);
+            }
+            out << "\n";
+        }
+    }
+}
+
+// Headless driver: runs the scenario without Qt and writes the results as CSV
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream out(options.output);
+    if (!out)
+    {
+        std::cerr << "Cannot open " << options.output << " for writing" << std::endl;
+        return 1;
+    }
+    out.precision(17);
+
+    const auto start = std::chrono::steady_clock::now();
+    // A smoother buffer that cannot be written ends the run with a message
+    try
+    {
+        if (options.runs == 0)
+        {
+            const Solution solution(options.seed, options.settings);
+            writeSolution(solution, out);
+        }
+        else
+        {
+            // Ensemble filters with the tuning the single run found for this
+            // seed; only the simulation and the Q sweep are needed for it
+            Solution solution(Solution::Deferred{}, options.seed, options.settings);
+            solution.run([](Solution::Stage stage) { return stage != Solution::Stage::QSweep; });
+            kalman::Matrix<3, 3> F;
+            kalman::Matrix<1, 3> H;
+            for (nc::uint32 i = 0; i < 3; ++i)
+            {
+                for (nc::uint32 j = 0; j < 3; ++j)
+                {
+                    F(i, j) = solution.F(i, j);
+                }
+                H(0, i) = solution.H[i];
+            }
+            Ensemble ensemble(F, H, solution.x0, solution.Q_optimal[0], solution.n);
+            writeStatistics(ensemble.run(options.runs, options.seed), out);
+        }
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    std::cout << "Wrote " << options.output << " in " << std::chrono::duration<double, std::milli>(stop - start).count() << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+#ifndef CONING_H
+#define CONING_H
+
+#include "kalman.h"
+
+#include <array>
+#include <cstddef>
+
+// Multi-sample coning and sculling compensation (Ignagni/Savage form). Over a
+// window of Samples gyro and accelerometer increments the rotation vector and
+// the velocity increment, both in the body frame at the window start, are
+//   phi = sum a_i + sum_{i<j} k_ij a_i x a_j
+//   dv  = sum v_i + 1/2 (sum a_i) x (sum v_i) + sum_{i<j} k_ij (a_i x v_j + v_i x a_j)
+// One sample is the uncompensated case of hw/main.Rmd: phi = a, dv = v.
+namespace coning
+{
+    using Vector3 = kalman::Vector<3>;
+
+    inline Vector3 cross(const Vector3 &a, const Vector3 &b)
+    {
+        return { { a[1] * b[2] - a[2] * b[1] }, { a[2] * b[0] - a[0] * b[2] }, { a[0] * b[1] - a[1] * b[0] } };
+    }
+
+    // k_ij for samples i < j (0-based) of a window of the given size: Miller's
+    // 3-sample and Lee's 4-sample weights, optimal for pure coning, where the
+    // coning drift falls as the window length to the power 2 Samples
+    constexpr double weight(std::size_t samples, std::size_t i, std::size_t j)
+    {
+        switch (samples)
+        {
+        case 2:
+            return 2. / 3.;
+        case 3:
+            return j - i == 2 ? 9. / 20. : 27. / 40.;
+        case 4:
+            if (j - i == 1)
+            {
+                return 214. / 315.;
+            }
+            return j - i == 2 ? 46. / 105. : 54. / 105.;
+        default:
+            return 0.;
+        }
+    }
+
+    // Rotation vector and velocity increment of one window
+    struct Window
+    {
+        Vector3 rotation;
+        Vector3 velocity;
+    };
+
+    template <std::size_t Samples>
+    class Compensator
+    {
+        static_assert(Samples >= 1 && Samples <= 4, "Coning algorithms are defined for 1 to 4 samples");
+
+    public:
+        static constexpr std::size_t samples = Samples;
+
+        // Adds one sensor interval, true once the window is full
+        bool add(const Vector3 &angle, const Vector3 &velocity)
+        {
+            angles[count] = angle;
+            velocities[count] = velocity;
+            return ++count == Samples;
+        }
+
+        // Compensated increments of the full window; starts the next one
+        Window take()
+        {
+            count = 0;
+            const Vector3 alpha = sum(angles);
+            Window result { alpha, sum(velocities) };
+            if (Samples == 1)
+            {
+                return result;
+            }
+
+            result.velocity += 0.5 * cross(alpha, result.velocity);
+            for (std::size_t i = 0; i < Samples; ++i)
+            {
+                for (std::size_t j = i + 1; j < Samples; ++j)
+                {
+                    const double k = weight(Samples, i, j);
+                    result.rotation += k * cross(angles[i], angles[j]);
+                    result.velocity += k * (cross(angles[i], velocities[j]) + cross(velocities[i], angles[j]));
+                }
+            }
+            return result;
+        }
+
+    private:
+        std::array<Vector3, Samples> angles;
+        std::array<Vector3, Samples> velocities;
+        std::size_t count = 0;
+
+        static Vector3 sum(const std::array<Vector3, Samples> &values)
+        {
+            Vector3 result = values[0];
+            for (std::size_t i = 1; i < Samples; ++i)
+            {
+                result += values[i];
+            }
+            return result;
+        }
+    };
+}
+
+#endif // CONING_H
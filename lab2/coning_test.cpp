@@ -0,0 +1,117 @@
+#include "coning.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+// Compensated rotation vectors of a pure coning motion against the exact one.
+// The body attitude q(t) = (cos a/2, 0, sin a/2 cos Wt, sin a/2 sin Wt) has the
+// body rate w = (-2 W sin^2 a/2, -W sin a sin Wt, W sin a cos Wt), whose
+// integrals over a sensor interval are the gyro increments. The exact rotation
+// of a window is q(t0)* q(t1); every sample count is checked against it.
+namespace
+{
+    using coning::Vector3;
+    using Quaternion = std::array<double, 4>;
+
+    constexpr double half_angle = 1e-4;
+    constexpr double cone_rate = 2 * 3.14159265358979323846 * 2.;
+
+    Quaternion attitude(double t)
+    {
+        return { std::cos(half_angle), 0., std::sin(half_angle) * std::cos(cone_rate * t), std::sin(half_angle) * std::sin(cone_rate * t) };
+    }
+
+    Quaternion product(const Quaternion &a, const Quaternion &b)
+    {
+        return {
+            a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+            a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+            a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1],
+            a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0],
+        };
+    }
+
+    Vector3 rotationVector(const Quaternion &q)
+    {
+        const double norm = std::sqrt(q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        const double scale = norm > 0. ? 2. * std::atan2(norm, q[0]) / norm : 2.;
+        return { { q[1] * scale }, { q[2] * scale }, { q[3] * scale } };
+    }
+
+    Vector3 increment(double t0, double t1)
+    {
+        const double sin_a = std::sin(2. * half_angle);
+        const double sin_half = std::sin(half_angle);
+        return {
+            { -2. * cone_rate * sin_half * sin_half * (t1 - t0) },
+            { sin_a * (std::cos(cone_rate * t1) - std::cos(cone_rate * t0)) },
+            { sin_a * (std::sin(cone_rate * t1) - std::sin(cone_rate * t0)) },
+        };
+    }
+
+    // Coning drift: error of the cone axis component summed over one second
+    // of windows, each window being Samples sensor intervals long
+    template <std::size_t Samples>
+    double drift(double window_rate)
+    {
+        const double h = 1. / (window_rate * Samples);
+        coning::Compensator<Samples> compensator;
+        double sum = 0.;
+        for (std::size_t k = 0; k < static_cast<std::size_t>(window_rate) * Samples; ++k)
+        {
+            if (compensator.add(increment(k * h, (k + 1) * h), Vector3()))
+            {
+                const Quaternion q0 = attitude((k + 1 - Samples) * h);
+                const Vector3 exact = rotationVector(product({ q0[0], -q0[1], -q0[2], -q0[3] }, attitude((k + 1) * h)));
+                sum += compensator.take().rotation[0] - exact[0];
+            }
+        }
+        return std::abs(sum);
+    }
+
+    // Per window the error goes as the window length T to the power
+    // 2 Samples + 1, so the drift over one second goes as T^(2 Samples):
+    // halving the window must cut it by 2^(2 Samples), within 25 %
+    template <std::size_t Samples>
+    bool checkOrder(double window_rate)
+    {
+        const double coarse = drift<Samples>(window_rate);
+        const double fine = drift<Samples>(2. * window_rate);
+        const double expected = std::pow(2., 2. * Samples);
+        const bool passed = coarse / fine > 0.75 * expected && coarse / fine < 1.25 * expected;
+        std::printf("%s %zu samples: drift %.3e at %g windows/s, %.3e at %g, ratio %.1f (expected %g)\n", passed ? "ok  " : "FAIL", Samples, coarse, window_rate, fine, 2. * window_rate, coarse / fine, expected);
+        return passed;
+    }
+}
+
+int main()
+{
+    bool passed = true;
+
+    // One sample is the plain sum of the increments
+    coning::Compensator<1> plain;
+    const Vector3 a = { { 1e-3 }, { -2e-3 }, { 3e-3 } };
+    const Vector3 v = { { 0.1 }, { 0.2 }, { -0.3 } };
+    plain.add(a, v);
+    const coning::Window window = plain.take();
+    const bool identity = window.rotation[0] == a[0] && window.rotation[1] == a[1] && window.rotation[2] == a[2]
+        && window.velocity[0] == v[0] && window.velocity[1] == v[1] && window.velocity[2] == v[2];
+    std::printf("%s one sample is uncompensated\n", identity ? "ok  " : "FAIL");
+    passed &= identity;
+
+    // Short windows for the asymptotic order; the 4-sample drift needs long
+    // ones to stay above the terms of the cone amplitude the form leaves out
+    passed &= checkOrder<1>(40.);
+    passed &= checkOrder<2>(40.);
+    passed &= checkOrder<3>(20.);
+    passed &= checkOrder<4>(5.);
+
+    // More samples per window of the same length, less drift
+    const std::array<double, 4> drifts = { drift<1>(10.), drift<2>(10.), drift<3>(10.), drift<4>(10.) };
+    const bool decreasing = drifts[1] < 0.1 * drifts[0] && drifts[2] < 0.1 * drifts[1] && drifts[3] < 0.1 * drifts[2];
+    std::printf("%s drift at 10 windows/s: %.3e %.3e %.3e %.3e\n", decreasing ? "ok  " : "FAIL", drifts[0], drifts[1], drifts[2], drifts[3]);
+    passed &= decreasing;
+
+    return passed ? 0 : 1;
+}
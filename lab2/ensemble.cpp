@@ -0,0 +1,170 @@
+#include "ensemble.h"
+#include "kalmanfilter.h"
+#include "philox.h"
+#include "solution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Realisations are grouped into fixed-size chunks that are merged in order,
+    // so the statistics do not depend on the number of threads
+    constexpr std::size_t runs_per_chunk = 8;
+}
+
+Ensemble::Ensemble(const kalman::Matrix<3, 3> &F, const kalman::Matrix<1, 3> &H, const kalman::Vector<3> &x0, double q, std::size_t steps, unsigned threads)
+    : F(F)
+    , H(H)
+    , x0(x0)
+    , q(q)
+    , steps(steps)
+    , pool(threads)
+{
+}
+
+Ensemble::Statistics Ensemble::run(std::size_t runs, std::uint64_t seed)
+{
+    const std::size_t chunks = (runs + runs_per_chunk - 1) / runs_per_chunk;
+    std::vector<Workspace> workspaces(std::min<std::size_t>(pool.size(), chunks));
+
+    Accumulator total;
+    total.reset(steps);
+
+    // One wave keeps every workspace busy, then merges chunk by chunk
+    for (std::size_t wave = 0; wave < chunks; wave += workspaces.size())
+    {
+        const std::size_t count = std::min(workspaces.size(), chunks - wave);
+        pool.parallelFor(count, [&](std::size_t j)
+        {
+            Workspace &ws = workspaces[j];
+            ws.acc.reset(steps);
+            const std::size_t first = (wave + j) * runs_per_chunk;
+            for (std::size_t run = first; run < std::min(first + runs_per_chunk, runs); ++run)
+            {
+                simulate(seed, run, ws);
+            }
+        });
+
+        for (std::size_t j = 0; j < count; ++j)
+        {
+            total.merge(workspaces[j].acc);
+        }
+    }
+
+    Statistics stats;
+    stats.runs = total.count;
+    stats.mean = std::move(total.mean);
+    stats.stddev = Trajectory<3>(steps);
+    for (std::size_t i = 0; i < steps; ++i)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            stats.stddev(k, i) = total.count > 1 ? std::sqrt(total.m2(k, i) / static_cast<double>(total.count - 1)) : 0.;
+        }
+    }
+    return stats;
+}
+
+void Ensemble::simulate(std::uint64_t seed, std::size_t run, Workspace &ws) const
+{
+    // 1.1. White noise, standardized like Solution::generateWhiteNoise()
+    ws.w.resize(steps);
+    philox::Stream(seed, run).fillUniform(0, ws.w.data(), steps);
+    double sum = 0.;
+    for (const double value : ws.w)
+    {
+        sum += value;
+    }
+    const double mean = sum / static_cast<double>(steps);
+    double var = 0.;
+    for (const double value : ws.w)
+    {
+        var += (value - mean) * (value - mean);
+    }
+    const double scale = 1. / std::sqrt(var / static_cast<double>(steps));
+    for (double &value : ws.w)
+    {
+        value = (value - mean) * scale;
+    }
+
+    // 1.2. INS errors
+    const kalman::Vector<3> G = { {0}, {0}, {static_cast<double>(constants::T)} };
+    if (ws.x.size() != steps)
+    {
+        ws.x = Trajectory<3>(steps);
+        ws.z = Trajectory<1>(steps);
+    }
+    ws.x.setColumn(0, x0);
+    for (std::size_t i = 0; i + 1 < steps; ++i)
+    {
+        ws.x.setColumn(i + 1, F * ws.x.column(i) + constants::drift_noise * ws.w[i] * G);
+    }
+
+    // 1.3. Speed measurements
+    const double V = constants::measurement_noise * ws.x.max(0);
+    for (std::size_t i = 0; i < steps; ++i)
+    {
+        ws.z(0, i) = (H * ws.x.column(i))[0] + ws.w[i] * V;
+    }
+
+    // 2.2. Default Kalman Filter, errors go straight into the accumulator
+    kalman::Model<3, 1> model { F, H, {}, {} };
+    model.Q(2, 2) = q;
+    model.R(0, 0) = V * V;
+
+    std::array<double, 3> p_diag;
+    for (std::size_t k = 0; k < 3; ++k)
+    {
+        const double x_max = ws.x.max(k);
+        p_diag[k] = x_max * x_max;
+    }
+    KalmanFilter<3, 1> filter(model, kalman::Vector<3>(), kalman::Matrix<3, 3>::diagonal(p_diag));
+
+    ++ws.acc.count;
+    ws.acc.add(0, ws.x.column(0) - filter.state());
+    for (std::size_t i = 0; i + 1 < steps; ++i)
+    {
+        filter.step(ws.z.column(i + 1));
+        ws.acc.add(i + 1, ws.x.column(i + 1) - filter.state());
+    }
+}
+
+void Ensemble::Accumulator::reset(std::size_t steps)
+{
+    count = 0;
+    mean = Trajectory<3>(steps);
+    m2 = Trajectory<3>(steps);
+}
+
+void Ensemble::Accumulator::add(std::size_t step, const kalman::Vector<3> &err)
+{
+    for (std::size_t k = 0; k < 3; ++k)
+    {
+        const double delta = err[k] - mean(k, step);
+        mean(k, step) += delta / static_cast<double>(count);
+        m2(k, step) += delta * (err[k] - mean(k, step));
+    }
+}
+
+void Ensemble::Accumulator::merge(const Accumulator &other)
+{
+    if (other.count == 0)
+    {
+        return;
+    }
+
+    const double n_a = static_cast<double>(count);
+    const double n_b = static_cast<double>(other.count);
+    const double n_ab = n_a + n_b;
+    for (std::size_t i = 0; i < mean.size(); ++i)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            const double delta = other.mean(k, i) - mean(k, i);
+            mean(k, i) += delta * n_b / n_ab;
+            m2(k, i) += other.m2(k, i) + delta * delta * n_a * n_b / n_ab;
+        }
+    }
+    count += other.count;
+}
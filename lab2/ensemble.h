@@ -0,0 +1,63 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "kalman.h"
+#include "threadpool.h"
+#include "trajectory.h"
+
+#include <cstdint>
+#include <vector>
+
+// Monte Carlo runner: simulates many independent INS error realisations,
+// filters each one and keeps per-step statistics of the estimation error
+// (x - x_est). Trajectories are never stored, memory is O(threads * n).
+// Realisation r draws its noise from the Philox stream (seed, r).
+class Ensemble
+{
+public:
+    struct Statistics
+    {
+        std::size_t runs = 0;
+        Trajectory<3> mean;
+        Trajectory<3> stddev;
+    };
+
+    // F and H of the error model, initial state, process noise q and steps per run
+    Ensemble(const kalman::Matrix<3, 3> &F, const kalman::Matrix<1, 3> &H, const kalman::Vector<3> &x0, double q, std::size_t steps, unsigned threads = std::thread::hardware_concurrency());
+
+    Statistics run(std::size_t runs, std::uint64_t seed);
+
+    // Running per-step mean and sum of squared deviations (Welford / Chan).
+    // count is bumped once per realisation, before its steps are added.
+    struct Accumulator
+    {
+        std::size_t count = 0;
+        Trajectory<3> mean;
+        Trajectory<3> m2;
+
+        void reset(std::size_t steps);
+        void add(std::size_t step, const kalman::Vector<3> &err);
+        void merge(const Accumulator &other);
+    };
+
+private:
+    // Per-thread scratch buffers for one realisation
+    struct Workspace
+    {
+        std::vector<double> w;
+        Trajectory<3> x;
+        Trajectory<1> z;
+        Accumulator acc;
+    };
+
+    const kalman::Matrix<3, 3> F;
+    const kalman::Matrix<1, 3> H;
+    const kalman::Vector<3> x0;
+    const double q;
+    const std::size_t steps;
+    ThreadPool pool;
+
+    void simulate(std::uint64_t seed, std::size_t run, Workspace &ws) const;
+};
+
+#endif // ENSEMBLE_H
@@ -0,0 +1,125 @@
+#include "ensemble.h"
+#include "philox.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Chan's merge of per-chunk accumulators against one Welford pass and the
+// two-pass textbook sums, and thread-count invariance of Ensemble::run
+namespace
+{
+    constexpr std::size_t steps = 50;
+    constexpr std::size_t realisations = 37;
+
+    // Errors with a large common offset, where a naive sum of squares loses digits
+    kalman::Vector<3> sample(std::size_t run, std::size_t step)
+    {
+        const philox::Stream stream(7, run);
+        kalman::Vector<3> err;
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            err[k] = 1e3 * static_cast<double>(k + 1) + stream.uniform(3 * step + k) - 0.5;
+        }
+        return err;
+    }
+
+    void addRun(Ensemble::Accumulator &acc, std::size_t run)
+    {
+        ++acc.count;
+        for (std::size_t i = 0; i < steps; ++i)
+        {
+            acc.add(i, sample(run, i));
+        }
+    }
+
+    double relative(double value, double reference)
+    {
+        return std::abs(value - reference) / std::max(std::abs(reference), 1e-300);
+    }
+
+    bool check(const char *name, double value, double tolerance)
+    {
+        const bool passed = value <= tolerance;
+        std::cout << (passed ? "ok   " : "FAIL ") << name << ": " << value << std::endl;
+        return passed;
+    }
+}
+
+int main()
+{
+    bool passed = true;
+
+    Ensemble::Accumulator single;
+    single.reset(steps);
+    for (std::size_t run = 0; run < realisations; ++run)
+    {
+        addRun(single, run);
+    }
+
+    // Uneven chunks, the first one merged into an empty total
+    Ensemble::Accumulator merged;
+    merged.reset(steps);
+    const std::vector<std::size_t> chunks = { 1, 8, 8, 13, 0, 7 };
+    std::size_t run = 0;
+    for (const std::size_t size : chunks)
+    {
+        Ensemble::Accumulator chunk;
+        chunk.reset(steps);
+        for (std::size_t j = 0; j < size; ++j, ++run)
+        {
+            addRun(chunk, run);
+        }
+        merged.merge(chunk);
+    }
+    passed &= check("merged count", merged.count == realisations ? 0. : 1., 0.);
+
+    double merge_mean = 0.;
+    double merge_m2 = 0.;
+    double exact_mean = 0.;
+    double exact_m2 = 0.;
+    for (std::size_t i = 0; i < steps; ++i)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            double sum = 0.;
+            for (std::size_t r = 0; r < realisations; ++r)
+            {
+                sum += sample(r, i)[k];
+            }
+            const double mean = sum / static_cast<double>(realisations);
+            double m2 = 0.;
+            for (std::size_t r = 0; r < realisations; ++r)
+            {
+                m2 += (sample(r, i)[k] - mean) * (sample(r, i)[k] - mean);
+            }
+
+            merge_mean = std::max(merge_mean, relative(merged.mean(k, i), single.mean(k, i)));
+            merge_m2 = std::max(merge_m2, relative(merged.m2(k, i), single.m2(k, i)));
+            exact_mean = std::max(exact_mean, relative(single.mean(k, i), mean));
+            exact_m2 = std::max(exact_m2, relative(single.m2(k, i), m2));
+        }
+    }
+    passed &= check("merged vs single pass, mean", merge_mean, 1e-14);
+    passed &= check("merged vs single pass, m2", merge_m2, 1e-10);
+    passed &= check("single pass vs two-pass, mean", exact_mean, 1e-14);
+    passed &= check("single pass vs two-pass, m2", exact_m2, 1e-10);
+
+    // Chunks are merged in a fixed order, so the thread count cannot change the result
+    const kalman::Matrix<3, 3> F = { { 1., -9.81, 0. }, { 1. / 6'371'300, 1., 1. }, { 0., 0., 1. } };
+    const kalman::Matrix<1, 3> H = { { 1., 0., 0. } };
+    const kalman::Vector<3> x0 = { { 0. }, { 0. }, { 4.8e-7 } };
+    const Ensemble::Statistics one = Ensemble(F, H, x0, 1e-14, 600, 1).run(21, 3);
+    const Ensemble::Statistics four = Ensemble(F, H, x0, 1e-14, 600, 4).run(21, 3);
+    double difference = one.runs == 21 && four.runs == 21 ? 0. : 1.;
+    for (std::size_t i = 0; i < 600; ++i)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            difference = std::max({ difference, std::abs(one.mean(k, i) - four.mean(k, i)), std::abs(one.stddev(k, i) - four.stddev(k, i)) });
+        }
+    }
+    passed &= check("1 vs 4 threads", difference, 0.);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+#include "arguments.h"
+#include "plotbuilder.h"
+
+#include <QApplication>
+#include <QDir>
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <string>
+
+namespace
+{
+    struct Options
+    {
+        std::uint64_t seed = 0;
+        std::size_t runs = 1;
+        QString output = "report";
+        bool png = true;
+        bool pdf = false;
+        int width = 1200;
+        int height = 400;
+    };
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--seed N] [--runs N] [--output DIR] [--format png|pdf|all] [--width PX] [--height PX]" << std::endl
+                  << "  --seed N       seed of the first run (default 0)" << std::endl
+                  << "  --runs N       number of runs, seeds seed .. seed + N - 1 (default 1)" << std::endl
+                  << "  --output DIR   report directory, one subdirectory per seed (default report)" << std::endl
+                  << "  --format F     png, pdf or all (default png)" << std::endl
+                  << "  --width PX     plot width (default 1200)" << std::endl
+                  << "  --height PX    plot height (default 400)" << std::endl;
+    }
+
+    bool parseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const bool has_value = i + 1 < argc;
+            if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.seed))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--runs") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.runs))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--output") == 0 && has_value)
+            {
+                options.output = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--format") == 0 && has_value)
+            {
+                const std::string format = argv[++i];
+                options.png = format == "png" || format == "all";
+                options.pdf = format == "pdf" || format == "all";
+                if (!options.png && !options.pdf)
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--width") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.width))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--height") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.height))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char *plotNames[3] = { "speed", "angle", "drift" };
+}
+
+// Headless report: renders every combo box view of every run to image files.
+// Runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise. The
+// next Solution is computed while the current one is rendered, and the plot
+// data of a run is built on a thread pool; only the painting itself stays on
+// the GUI thread, as Qt requires.
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    Options options;
+    if (!parseOptions(argc, argv, options) || options.runs == 0 || options.width <= 0 || options.height <= 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::array<QCustomPlot, 3> widgets;
+    std::array<QCustomPlot *, 3> plots;
+    for (std::size_t k = 0; k < plots.size(); ++k)
+    {
+        plots[k] = &widgets[k];
+        plots[k]->resize(options.width, options.height);
+    }
+    PlotBuilder builder(plots);
+    ThreadPool pool;
+
+    // Batch views only, the live one has nothing to export
+    std::vector<plotview::View> views;
+    for (const plotview::View &view : plotview::views())
+    {
+        if (!view.live)
+        {
+            views.push_back(view);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::future<std::unique_ptr<Solution>> next = std::async(std::launch::async, [&options]()
+    {
+        return std::unique_ptr<Solution>(new Solution(options.seed));
+    });
+    for (std::size_t run = 0; run < options.runs; ++run)
+    {
+        const std::uint64_t seed = options.seed + run;
+        const std::unique_ptr<Solution> solution = next.get();
+        if (run + 1 < options.runs)
+        {
+            next = std::async(std::launch::async, [seed]()
+            {
+                return std::unique_ptr<Solution>(new Solution(seed + 1));
+            });
+        }
+
+        builder.clear();
+        for (int stage = 0; stage < Solution::stages; ++stage)
+        {
+            builder.assign(*solution, static_cast<Solution::Stage>(stage));
+        }
+        builder.prefetch(views, pool);
+
+        const QDir dir(QString("%1/seed_%2").arg(options.output).arg(seed));
+        if (!dir.mkpath("."))
+        {
+            std::cerr << "Cannot create " << dir.path().toStdString() << std::endl;
+            return 1;
+        }
+
+        for (std::size_t v = 0; v < views.size(); ++v)
+        {
+            builder.show(views[v]);
+            for (std::size_t k = 0; k < plots.size(); ++k)
+            {
+                const QString base = dir.filePath(QString("view%1_%2").arg(v + 1).arg(plotNames[k]));
+                if (options.png && !plots[k]->savePng(base + ".png", options.width, options.height))
+                {
+                    std::cerr << "Cannot write " << (base + ".png").toStdString() << std::endl;
+                    return 1;
+                }
+                if (options.pdf && !plots[k]->savePdf(base + ".pdf", options.width, options.height))
+                {
+                    std::cerr << "Cannot write " << (base + ".pdf").toStdString() << std::endl;
+                    return 1;
+                }
+            }
+        }
+        std::cout << "Exported seed " << seed << " to " << dir.path().toStdString() << std::endl;
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    std::cout << "Exported " << options.runs << " runs in " << std::chrono::duration<double, std::milli>(stop - start).count() << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,312 @@
+#ifndef KALMAN_H
+#define KALMAN_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+// Fixed-size linear algebra and Kalman predict/update kernel.
+// Everything lives on the stack, so the filter loops do not allocate.
+// The element type defaults to double; a SIMD pack runs one filter per lane.
+namespace kalman
+{
+    template <std::size_t Rows, std::size_t Cols, typename T = double>
+    struct Matrix
+    {
+        // Row-major storage
+        std::array<T, Rows * Cols> data {};
+
+        Matrix() = default;
+
+        Matrix(std::initializer_list<std::initializer_list<T>> rows)
+        {
+            std::size_t r = 0;
+            for (const auto &row : rows)
+            {
+                std::size_t c = 0;
+                for (const T &value : row)
+                {
+                    (*this)(r, c++) = value;
+                }
+                ++r;
+            }
+        }
+
+        static constexpr std::size_t rows() { return Rows; }
+        static constexpr std::size_t cols() { return Cols; }
+
+        T &operator()(std::size_t r, std::size_t c) { return data[r * Cols + c]; }
+        const T &operator()(std::size_t r, std::size_t c) const { return data[r * Cols + c]; }
+
+        // Flat access, convenient for vectors
+        T &operator[](std::size_t i) { return data[i]; }
+        const T &operator[](std::size_t i) const { return data[i]; }
+
+        static Matrix zeros() { return Matrix(); }
+
+        static Matrix identity()
+        {
+            static_assert(Rows == Cols, "Identity matrix must be square");
+            Matrix result;
+            for (std::size_t i = 0; i < Rows; ++i)
+            {
+                result(i, i) = T(1.);
+            }
+            return result;
+        }
+
+        static Matrix diagonal(const std::array<T, Rows> &values)
+        {
+            static_assert(Rows == Cols, "Diagonal matrix must be square");
+            Matrix result;
+            for (std::size_t i = 0; i < Rows; ++i)
+            {
+                result(i, i) = values[i];
+            }
+            return result;
+        }
+
+        Matrix &operator+=(const Matrix &other)
+        {
+            for (std::size_t i = 0; i < Rows * Cols; ++i)
+            {
+                data[i] += other.data[i];
+            }
+            return *this;
+        }
+
+        Matrix &operator-=(const Matrix &other)
+        {
+            for (std::size_t i = 0; i < Rows * Cols; ++i)
+            {
+                data[i] -= other.data[i];
+            }
+            return *this;
+        }
+
+        Matrix &operator*=(const T &scalar)
+        {
+            for (T &value : data)
+            {
+                value *= scalar;
+            }
+            return *this;
+        }
+    };
+
+    template <std::size_t N, typename T = double>
+    using Vector = Matrix<N, 1, T>;
+
+    template <std::size_t Rows, std::size_t Cols, typename T>
+    Matrix<Rows, Cols, T> operator+(Matrix<Rows, Cols, T> lhs, const Matrix<Rows, Cols, T> &rhs)
+    {
+        return lhs += rhs;
+    }
+
+    template <std::size_t Rows, std::size_t Cols, typename T>
+    Matrix<Rows, Cols, T> operator-(Matrix<Rows, Cols, T> lhs, const Matrix<Rows, Cols, T> &rhs)
+    {
+        return lhs -= rhs;
+    }
+
+    template <std::size_t Rows, std::size_t Cols, typename T>
+    Matrix<Rows, Cols, T> operator*(const T &scalar, Matrix<Rows, Cols, T> m)
+    {
+        return m *= scalar;
+    }
+
+    template <std::size_t Rows, std::size_t Cols, typename T>
+    Matrix<Rows, Cols, T> operator*(Matrix<Rows, Cols, T> m, const T &scalar)
+    {
+        return m *= scalar;
+    }
+
+    template <std::size_t Rows, std::size_t Inner, std::size_t Cols, typename T>
+    Matrix<Rows, Cols, T> operator*(const Matrix<Rows, Inner, T> &lhs, const Matrix<Inner, Cols, T> &rhs)
+    {
+        Matrix<Rows, Cols, T> result;
+        for (std::size_t r = 0; r < Rows; ++r)
+        {
+            for (std::size_t k = 0; k < Inner; ++k)
+            {
+                const T value = lhs(r, k);
+                for (std::size_t c = 0; c < Cols; ++c)
+                {
+                    result(r, c) += value * rhs(k, c);
+                }
+            }
+        }
+        return result;
+    }
+
+    template <std::size_t Rows, std::size_t Cols, typename T>
+    Matrix<Cols, Rows, T> transpose(const Matrix<Rows, Cols, T> &m)
+    {
+        Matrix<Cols, Rows, T> result;
+        for (std::size_t r = 0; r < Rows; ++r)
+        {
+            for (std::size_t c = 0; c < Cols; ++c)
+            {
+                result(c, r) = m(r, c);
+            }
+        }
+        return result;
+    }
+
+    // Gauss-Jordan inversion with partial pivoting, meant for the small
+    // innovation covariance (1x1 for the speed measurement). Pivoting needs
+    // scalar comparisons, so packed lanes are limited to the 1x1 case.
+    template <std::size_t N, typename T>
+    Matrix<N, N, T> inverse(Matrix<N, N, T> m)
+    {
+        Matrix<N, N, T> result = Matrix<N, N, T>::identity();
+        for (std::size_t col = 0; col < N; ++col)
+        {
+            std::size_t pivot = col;
+            for (std::size_t r = col + 1; r < N; ++r)
+            {
+                if (std::abs(m(r, col)) > std::abs(m(pivot, col)))
+                {
+                    pivot = r;
+                }
+            }
+            if (pivot != col)
+            {
+                for (std::size_t c = 0; c < N; ++c)
+                {
+                    std::swap(m(col, c), m(pivot, c));
+                    std::swap(result(col, c), result(pivot, c));
+                }
+            }
+
+            const T scale = T(1.) / m(col, col);
+            for (std::size_t c = 0; c < N; ++c)
+            {
+                m(col, c) *= scale;
+                result(col, c) *= scale;
+            }
+
+            for (std::size_t r = 0; r < N; ++r)
+            {
+                if (r == col)
+                {
+                    continue;
+                }
+                const T factor = m(r, col);
+                for (std::size_t c = 0; c < N; ++c)
+                {
+                    m(r, c) -= factor * m(col, c);
+                    result(r, c) -= factor * result(col, c);
+                }
+            }
+        }
+        return result;
+    }
+
+    template <typename T>
+    Matrix<1, 1, T> inverse(Matrix<1, 1, T> m)
+    {
+        m(0, 0) = T(1.) / m(0, 0);
+        return m;
+    }
+
+    // Linear time-invariant model: x(k+1) = F x(k) + w, z(k) = H x(k) + v
+    template <std::size_t N, std::size_t M, typename T = double>
+    struct Model
+    {
+        Matrix<N, N, T> F;
+        Matrix<M, N, T> H;
+        Matrix<N, N, T> Q;
+        Matrix<M, M, T> R;
+    };
+
+    // Estimate and its covariance
+    template <std::size_t N, typename T = double>
+    struct State
+    {
+        Vector<N, T> x;
+        Matrix<N, N, T> p;
+    };
+
+    // x = F x, P = F p F' + Q
+    template <std::size_t N, std::size_t M, typename T>
+    void predict(const Model<N, M, T> &model, State<N, T> &state)
+    {
+        state.x = model.F * state.x;
+        state.p = model.F * state.p * transpose(model.F) + model.Q;
+    }
+
+    // K = P H' (H P H' + R)^-1, x = x + K (z - H x), p = (I - K H) P.
+    // Returns the gain used, so callers can inspect or reuse it.
+    template <std::size_t N, std::size_t M, typename T>
+    Matrix<N, M, T> update(const Model<N, M, T> &model, State<N, T> &state, const Vector<M, T> &z)
+    {
+        const Matrix<N, M, T> PHt = state.p * transpose(model.H);
+        const Matrix<N, M, T> K = PHt * inverse(model.H * PHt + model.R);
+        state.x += K * (z - model.H * state.x);
+        state.p = (Matrix<N, N, T>::identity() - K * model.H) * state.p;
+        return K;
+    }
+
+    // Largest change between two covariances, each element scaled by its
+    // diagonal standard deviations so that all state components weigh alike
+    template <std::size_t N>
+    double relativeChange(const Matrix<N, N> &current, const Matrix<N, N> &previous)
+    {
+        double result = 0.;
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                const double scale = std::sqrt(std::abs(current(i, i) * current(j, j)));
+                const double change = std::abs(current(i, j) - previous(i, j));
+                result = std::max(result, scale > 0. ? change / scale : change);
+            }
+        }
+        return result;
+    }
+
+    // Steady-state gain and updated covariance of a time-invariant model
+    template <std::size_t N, std::size_t M>
+    struct SteadyState
+    {
+        Matrix<N, M> K;
+        Matrix<N, N> p;
+        std::size_t iterations = 0;
+        bool converged = false;
+    };
+
+    // Solves the discrete algebraic Riccati equation by iterating the covariance
+    // recursion from p until successive updates differ by less than tolerance.
+    // The iteration count equals the step at which a filter started from the
+    // same p reaches its constant gain.
+    template <std::size_t N, std::size_t M>
+    SteadyState<N, M> steadyState(const Model<N, M> &model, Matrix<N, N> p, double tolerance, std::size_t max_iterations)
+    {
+        SteadyState<N, M> result;
+        State<N> state { {}, p };
+        while (result.iterations < max_iterations && !result.converged)
+        {
+            predict(model, state);
+            result.K = update(model, state, Vector<M>());
+            result.converged = relativeChange(state.p, p) < tolerance;
+            p = state.p;
+            ++result.iterations;
+        }
+        result.p = p;
+        return result;
+    }
+
+    // Constant-gain step once the covariance has settled: x = F x + K (z - H F x)
+    template <std::size_t N, std::size_t M, typename T>
+    void predictUpdate(const Model<N, M, T> &model, Vector<N, T> &x, const Matrix<N, M, T> &K, const Vector<M, T> &z)
+    {
+        x = model.F * x;
+        x += K * (z - model.H * x);
+    }
+}
+
+#endif // KALMAN_H
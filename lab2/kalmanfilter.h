@@ -0,0 +1,95 @@
+#ifndef KALMANFILTER_H
+#define KALMANFILTER_H
+
+#include "kalman.h"
+
+// Online Kalman filter: fed one measurement at a time, keeps only the current
+// estimate, so memory is O(1) regardless of how long it runs.
+template <std::size_t N, std::size_t M>
+class KalmanFilter
+{
+public:
+    using Model = kalman::Model<N, M>;
+
+    KalmanFilter(const Model &model, const kalman::Vector<N> &x0, const kalman::Matrix<N, N> &p0)
+        : model(model)
+        , current { x0, p0 }
+    {
+    }
+
+    // Time update. Once the gain is constant only the state is propagated.
+    void predict()
+    {
+        if (steady)
+        {
+            current.x = model.F * current.x;
+            return;
+        }
+        p_prev = current.p;
+        kalman::predict(model, current);
+    }
+
+    // Measurement update, must follow predict()
+    void update(const kalman::Vector<M> &z)
+    {
+        ++count;
+        if (steady)
+        {
+            current.x += K * (z - model.H * current.x);
+            return;
+        }
+        K = kalman::update(model, current, z);
+        if (tolerance > 0. && kalman::relativeChange(current.p, p_prev) < tolerance)
+        {
+            steady = true;
+        }
+    }
+
+    void step(const kalman::Vector<M> &z)
+    {
+        predict();
+        update(z);
+    }
+
+    // Holds the gain constant once successive covariances differ by less than
+    // tolerance; 0 keeps the full recursion
+    void setSteadyStateTolerance(double tolerance)
+    {
+        this->tolerance = tolerance;
+    }
+
+    // Uses a precomputed gain (e.g. kalman::steadyState) from now on
+    void setGain(const kalman::Matrix<N, M> &K)
+    {
+        this->K = K;
+        steady = true;
+    }
+
+    // Restarts the covariance recursion, e.g. after a measurement outage
+    void resetCovariance(const kalman::Matrix<N, N> &p)
+    {
+        current.p = p;
+        steady = false;
+    }
+
+    bool isSteady() const { return steady; }
+
+    // Measurement updates processed so far
+    std::size_t steps() const { return count; }
+
+    const kalman::Vector<N> &state() const { return current.x; }
+    const kalman::Matrix<N, N> &covariance() const { return current.p; }
+    const kalman::Matrix<N, M> &gain() const { return K; }
+
+private:
+    const Model model;
+    kalman::State<N> current;
+    kalman::Matrix<N, N> p_prev;
+    kalman::Matrix<N, M> K;
+
+    double tolerance = 0.;
+    bool steady = false;
+    std::size_t count = 0;
+};
+
+#endif // KALMANFILTER_H
@@ -0,0 +1,141 @@
+#include "livestream.h"
+#include "plotview.h"
+
+#include <chrono>
+
+LiveStream::LiveStream(const std::array<QCustomPlot *, 3> &plots, QObject *parent)
+    : QObject(parent)
+    , plots(plots)
+{
+    timer.setTimerType(Qt::PreciseTimer);
+    setFrameRate(livestream::frame_rate);
+    connect(&timer, &QTimer::timeout, this, &LiveStream::onFrame);
+}
+
+LiveStream::~LiveStream()
+{
+    stop();
+}
+
+void LiveStream::setWindow(double seconds)
+{
+    window = seconds;
+}
+
+void LiveStream::setFrameRate(int fps)
+{
+    timer.setInterval(1000 / std::max(fps, 1));
+}
+
+void LiveStream::setSampleRate(double samples_per_second)
+{
+    sample_rate = samples_per_second;
+}
+
+void LiveStream::start(const TrajectoryView<3> &x, const TrajectoryView<1> &z, const KalmanFilter<3, 1> &filter, const std::array<std::array<QString, 2>, 3> &names)
+{
+    stop();
+    ring->clear();
+
+    for (std::size_t k = 0; k < plots.size(); ++k)
+    {
+        truth[k] = plots[k]->addGraph();
+        truth[k]->setPen(QPen(Qt::blue));
+        truth[k]->setName(names[k][0]);
+        estimate[k] = plots[k]->addGraph();
+        estimate[k]->setPen(QPen(Qt::red));
+        estimate[k]->setName(names[k][1]);
+    }
+
+    stopping = false;
+    produced = false;
+    const double period = 1. / sample_rate;
+    producer = std::thread([this, x, z, filter, period]() mutable
+    {
+        auto next = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < x.size() && !stopping; ++i)
+        {
+            if (i > 0)
+            {
+                filter.step(z.column(i));
+            }
+
+            // The GUI is behind: wait for room rather than drop samples
+            const Sample sample { static_cast<double>(i * constants::T), x.column(i), filter.state() };
+            while (!ring->push(sample))
+            {
+                if (stopping)
+                {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period));
+            std::this_thread::sleep_until(next);
+        }
+        produced = true;
+    });
+
+    timer.start();
+}
+
+void LiveStream::stop()
+{
+    timer.stop();
+    stopping = true;
+    if (producer.joinable())
+    {
+        producer.join();
+    }
+
+    for (std::size_t k = 0; k < plots.size(); ++k)
+    {
+        if (truth[k])
+        {
+            plots[k]->removeGraph(truth[k]);
+            plots[k]->removeGraph(estimate[k]);
+        }
+    }
+    truth = {};
+    estimate = {};
+}
+
+void LiveStream::onFrame()
+{
+    const bool finished = produced;
+    double t_last = 0.;
+    // Same units as the batch views
+    const std::array<plotview::Axis, 3> &axes = plotview::axes();
+    const std::size_t count = ring->drain([&](const Sample &sample)
+    {
+        for (std::size_t k = 0; k < plots.size(); ++k)
+        {
+            truth[k]->addData(sample.t, sample.x[k] * axes[k].scale);
+            estimate[k]->addData(sample.t, sample.estimate[k] * axes[k].scale);
+        }
+        t_last = sample.t;
+    });
+
+    if (count > 0)
+    {
+        for (std::size_t k = 0; k < plots.size(); ++k)
+        {
+            truth[k]->data()->removeBefore(t_last - window);
+            estimate[k]->data()->removeBefore(t_last - window);
+
+            plots[k]->xAxis->setRange(std::max(0., t_last - window), std::max(t_last, window));
+            truth[k]->rescaleValueAxis(false, true);
+            estimate[k]->rescaleValueAxis(true, true);
+
+            // Coalesced with any other replot request into the next frame
+            plots[k]->replot(QCustomPlot::rpQueuedReplot);
+        }
+    }
+
+    // Everything produced has been drawn
+    if (finished && count == 0)
+    {
+        timer.stop();
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef LIVESTREAM_H
+#define LIVESTREAM_H
+
+#include <QObject>
+#include <QTimer>
+#include "qcustomplot.h"
+#include "solution.h"
+#include "spscring.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace livestream
+{
+    // Defaults: scrolling window in s, redraw rate and replay speed in steps per second
+    constexpr double window = 600.;
+    constexpr int frame_rate = 30;
+    constexpr double sample_rate = 500.;
+}
+
+// Live view of the online filter. A producer thread replays the measurements
+// through a KalmanFilter at a fixed sample rate and pushes every step into an
+// SPSC ring; the GUI thread drains it once per frame, appends to the speed,
+// angle and drift plots and keeps a scrolling window of the latest samples.
+class LiveStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Sample
+    {
+        double t;
+        kalman::Vector<3> x;
+        kalman::Vector<3> estimate;
+    };
+
+    LiveStream(const std::array<QCustomPlot *, 3> &plots, QObject *parent = nullptr);
+    ~LiveStream();
+
+    // Length of the scrolling window, s of simulation time
+    void setWindow(double seconds);
+    void setFrameRate(int fps);
+    void setSampleRate(double samples_per_second);
+
+    // Adds a truth and an estimate graph per plot, named after names[plot],
+    // and starts feeding them. Stops a previous run first.
+    void start(const TrajectoryView<3> &x, const TrajectoryView<1> &z, const KalmanFilter<3, 1> &filter, const std::array<std::array<QString, 2>, 3> &names);
+
+    // Joins the producer and removes the graphs from the plots
+    void stop();
+
+private slots:
+    void onFrame();
+
+private:
+    const std::array<QCustomPlot *, 3> plots;
+    std::array<QCPGraph *, 3> truth {};
+    std::array<QCPGraph *, 3> estimate {};
+
+    std::unique_ptr<SpscRing<Sample, 4096>> ring { new SpscRing<Sample, 4096>() };
+    std::thread producer;
+    std::atomic<bool> stopping { false };
+    std::atomic<bool> produced { false };
+    QTimer timer;
+
+    double window = livestream::window;
+    double sample_rate = livestream::sample_rate;
+};
+
+#endif // LIVESTREAM_H
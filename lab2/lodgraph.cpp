@@ -0,0 +1,129 @@
+#include "lodgraph.h"
+
+#include <algorithm>
+#include <cmath>
+
+LodPyramid::LodPyramid(const QCPGraphDataContainer &data)
+{
+    std::vector<Bucket> finest;
+    if (!data.isEmpty())
+    {
+        appendFinest(&*data.constBegin(), &*data.constBegin() + data.size(), finest);
+    }
+    buildLevels(std::move(finest));
+}
+
+LodPyramid::LodPyramid(std::vector<Bucket> finest)
+{
+    buildLevels(std::move(finest));
+}
+
+void LodPyramid::appendFinest(const QCPGraphData *begin, const QCPGraphData *end, std::vector<Bucket> &finest)
+{
+    const std::ptrdiff_t bucket_size = std::ptrdiff_t(1) << base_shift;
+    finest.reserve(finest.size() + static_cast<std::size_t>((end - begin + bucket_size - 1) / bucket_size));
+    for (const QCPGraphData *it = begin; it != end; )
+    {
+        Bucket bucket { *it, *it };
+        const QCPGraphData *bucket_end = it + std::min(bucket_size, end - it);
+        for (++it; it != bucket_end; ++it)
+        {
+            if (it->value < bucket.min.value)
+            {
+                bucket.min = *it;
+            }
+            if (it->value > bucket.max.value)
+            {
+                bucket.max = *it;
+            }
+        }
+        finest.push_back(bucket);
+    }
+}
+
+void LodPyramid::buildLevels(std::vector<Bucket> finest)
+{
+    // Too short to be worth decimating
+    if (finest.size() < 2)
+    {
+        return;
+    }
+    levels_.push_back(std::move(finest));
+
+    // Every coarser level merges pairs of the previous one
+    while (levels_.back().size() > 1)
+    {
+        const std::vector<Bucket> &fine = levels_.back();
+        std::vector<Bucket> coarse((fine.size() + 1) / 2);
+        for (std::size_t i = 0; i < coarse.size(); ++i)
+        {
+            coarse[i] = fine[2 * i];
+            if (2 * i + 1 < fine.size())
+            {
+                const Bucket &next = fine[2 * i + 1];
+                if (next.min.value < coarse[i].min.value)
+                {
+                    coarse[i].min = next.min;
+                }
+                if (next.max.value > coarse[i].max.value)
+                {
+                    coarse[i].max = next.max;
+                }
+            }
+        }
+        levels_.push_back(std::move(coarse));
+    }
+}
+
+LodGraph::LodGraph(QCPAxis *keyAxis, QCPAxis *valueAxis)
+    : QCPGraph(keyAxis, valueAxis)
+{
+}
+
+void LodGraph::setData(QSharedPointer<QCPGraphDataContainer> data, std::shared_ptr<const LodPyramid> pyramid)
+{
+    QCPGraph::setData(data);
+    this->pyramid = std::move(pyramid);
+}
+
+void LodGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
+{
+    if (!lineData || !pyramid || pyramid->levels() == 0 || begin == end)
+    {
+        QCPGraph::getOptimizedLineData(lineData, begin, end);
+        return;
+    }
+
+    const int first = static_cast<int>(begin - mDataContainer->constBegin());
+    const int last = static_cast<int>(end - mDataContainer->constBegin()) - 1;
+    const double pixels = std::max(1., std::abs(mKeyAxis->coordToPixel((end - 1)->key) - mKeyAxis->coordToPixel(begin->key)));
+
+    // Coarsest level that still has at least one bucket per pixel
+    const double points_per_pixel = (last - first + 1) / pixels;
+    const int level = std::min(static_cast<int>(std::floor(std::log2(std::max(points_per_pixel, 1.)))) - LodPyramid::base_shift, pyramid->levels() - 1);
+    if (level < 0)
+    {
+        QCPGraph::getOptimizedLineData(lineData, begin, end);
+        return;
+    }
+
+    // Each bucket contributes its extremes in key order
+    const int shift = LodPyramid::base_shift + level;
+    const std::vector<LodPyramid::Bucket> &buckets = pyramid->level(level);
+    lineData->clear();
+    lineData->reserve(2 * ((last >> shift) - (first >> shift) + 1));
+    for (int i = first >> shift; i <= last >> shift; ++i)
+    {
+        const LodPyramid::Bucket &bucket = buckets[static_cast<std::size_t>(i)];
+        if (bucket.min.key <= bucket.max.key)
+        {
+            lineData->append(bucket.min);
+            lineData->append(bucket.max);
+        }
+        else
+        {
+            lineData->append(bucket.max);
+            lineData->append(bucket.min);
+        }
+    }
+}
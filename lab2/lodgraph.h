@@ -0,0 +1,67 @@
+#ifndef LODGRAPH_H
+#define LODGRAPH_H
+
+#include "qcustomplot.h"
+
+#include <memory>
+#include <vector>
+
+// Min/max decimation pyramid of a graph data container. Level l holds one
+// bucket per 2^(base_shift + l) points with the minimum and maximum point of
+// that span, so any level still shows every spike of the raw data.
+class LodPyramid
+{
+public:
+    struct Bucket
+    {
+        QCPGraphData min;
+        QCPGraphData max;
+    };
+
+    static constexpr int base_shift = 3;
+
+    explicit LodPyramid(const QCPGraphDataContainer &data);
+
+    // From a finest level collected elsewhere, e.g. chunk by chunk with appendFinest()
+    explicit LodPyramid(std::vector<Bucket> finest);
+
+    // Appends the finest-level buckets of [begin, end). When called per chunk,
+    // every chunk but the last must hold a multiple of 2^base_shift points.
+    static void appendFinest(const QCPGraphData *begin, const QCPGraphData *end, std::vector<Bucket> &finest);
+
+    int levels() const { return static_cast<int>(levels_.size()); }
+    const std::vector<Bucket> &level(int l) const { return levels_[l]; }
+
+private:
+    std::vector<std::vector<Bucket>> levels_;
+
+    void buildLevels(std::vector<Bucket> finest);
+};
+
+// Graph that draws from the pyramid level matching the pixel density of the
+// key axis, so the cost of a replot depends on the axis width, not on the
+// number of points. Below the first level it falls back to QCPGraph's own
+// adaptive sampling. The pyramid has to be built from the same container.
+class LodGraph : public QCPGraph
+{
+    Q_OBJECT
+
+public:
+    explicit LodGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+
+    void setData(QSharedPointer<QCPGraphDataContainer> data, std::shared_ptr<const LodPyramid> pyramid);
+
+protected:
+    void getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const override;
+
+private:
+    std::shared_ptr<const LodPyramid> pyramid;
+};
+
+// Adds a LodGraph on the default axes, the counterpart of QCustomPlot::addGraph()
+inline LodGraph *addLodGraph(QCustomPlot *plot)
+{
+    return new LodGraph(plot->xAxis, plot->yAxis);
+}
+
+#endif // LODGRAPH_H
@@ -2,8 +2,17 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QThread>
+#include "plotbuilder.h"
+#include "renderbackend.h"
+#include "qcustomplot.h"
 #include "solution.h"
 
+#include <array>
+
+class LiveStream;
+class QProgressBar;
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -21,57 +30,34 @@ public:
 private slots:
     void on_comboBox_currentIndexChanged(int index);
 
+    // Worker progress, delivered queued from the computation thread
+    void onStageFinished(int stage);
+    void onSolutionFinished(double ms);
+
 private:
     Ui::MainWindow *ui;
+    QProgressBar *progress;
+    LiveStream *live;
 
-    std::unique_ptr<Solution> solution { new Solution() };
-
-    nc::NdArray<double> x;
-    nc::NdArray<double> z;
-    nc::NdArray<double> t;
-
-    nc::NdArray<double> x_err;
-
-    nc::NdArray<double> x_err_pmin;
-    nc::NdArray<double> x_err_pmax;
-
-    nc::NdArray<double> x_err_rmin;
-    nc::NdArray<double> x_err_rmax;
-
-    nc::NdArray<double> x_err_qmin;
-    nc::NdArray<double> x_err_qmax;
-
-    nc::NdArray<double> x_err_long;
-    nc::NdArray<double> x_err_short;
-
-    void initializeValues();
-
-    void plotSpeedAndMeasurementsErrors();
-    void plotDeflectionAngleError();
-    void plotDriftSpeedError();
+    // Filled stage by stage on worker_thread
+    std::unique_ptr<Solution> solution { new Solution(Solution::Deferred{}) };
+    QThread worker_thread;
 
-    void plotSpeedAndMeasurementsFK();
-    void plotDeflectionAngleFK();
-    void plotDriftSpeedFK();
+    // Plot data cache and view execution for the three plots
+    std::unique_ptr<PlotBuilder> builder;
 
-    void plotSpeedAndMeasurementsP();
-    void plotDeflectionAngleP();
-    void plotDriftSpeedP();
+    // Hands the histories a finished stage has produced to the builder
+    void initializeValues(Solution::Stage stage);
 
-    void plotSpeedAndMeasurementsR();
-    void plotDeflectionAngleR();
-    void plotDriftSpeedR();
+    // Combo box entries stay disabled until their data is ready
+    void setViewEnabled(int index, bool enabled);
 
-    void plotSpeedAndMeasurementsQ();
-    void plotDeflectionAngleQ();
-    void plotDriftSpeedQ();
+    std::array<FrameTimeOverlay *, 3> frame_times {};
 
-    void plotSpeedAndMeasurementsLong();
-    void plotDeflectionAngleLong();
-    void plotDriftSpeedLong();
+    // Applies the backend to all three plots, true if every one ended up on OpenGL
+    bool setRenderBackend(renderbackend::Backend backend);
 
-    void plotSpeedAndMeasurementsShort();
-    void plotDeflectionAngleShort();
-    void plotDriftSpeedShort();
+    // Builds the view and starts the live stream if it is the live one
+    void showView(const plotview::View &view);
 };
 #endif // MAINWINDOW_H
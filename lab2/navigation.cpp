@@ -0,0 +1,390 @@
+#include "arguments.h"
+#include "batchstrapdown.h"
+#include "philox.h"
+#include "strapdown.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        double rate = 10.;
+        std::size_t divisor = 1;
+        strapdown::Pipeline pipeline;
+        bool open_loop = false;
+        bool inaccuracies = false;
+        double time = 2 * 60 * 60;
+        std::size_t every = 1;
+        std::size_t batch = 0;
+        std::uint64_t seed = 0;
+        std::string compare;
+        std::string output = "navigation.csv";
+    };
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--rate HZ] [--divisor N] [--coning N] [--earth MODEL] [--normalization METHOD] [--r-compatible] [--inaccuracies] [--open-loop] [--time S] [--every N] [--batch N [--seed N]] [--compare FILE] [--output FILE]" << std::endl
+                  << "  --rate HZ      IMU sample rate (default 10, as in hw/main.Rmd)" << std::endl
+                  << "  --divisor N    sensor samples per navigation update (default 1)" << std::endl
+                  << "  --coning N     coning/sculling window of 1 (none), 2, 3 or 4 samples (default 1)" << std::endl
+                  << "  --earth MODEL  wgs84 (default) or sphere radii in the frame rate" << std::endl
+                  << "  --normalization METHOD" << std::endl
+                  << "                 first-order (default) or exact quaternion normalization" << std::endl
+                  << "  --r-compatible sum the Coriolis terms without the h_N3 factor, as the R loop does;" << std::endl
+                  << "                 reproduces hw/main.Rmd at 10 Hz, divisor 1 (default: integrated over h_N3)" << std::endl
+                  << "  --inaccuracies add accelerometer bias and gyro drift" << std::endl
+                  << "  --open-loop    sensors follow the true attitude, not the computed one" << std::endl
+                  << "  --time S       simulated time in seconds (default 7200)" << std::endl
+                  << "  --every N      write only updates at multiples of N steps (default 1)" << std::endl
+                  << "  --batch N      sweep N trajectories with random phi_0, eps_0, turn axis and, with" << std::endl
+                  << "                 --inaccuracies, bias and drift; write their final outputs" << std::endl
+                  << "  --seed N       stream seed of the sweep (default 0)" << std::endl
+                  << "  --compare FILE check the run against a reference CSV (t and the output columns)" << std::endl
+                  << "                 instead of writing one; fails when a column exceeds its tolerance;" << std::endl
+                  << "                 needs --r-compatible" << std::endl
+                  << "  --output FILE  CSV file to write (default navigation.csv)" << std::endl;
+    }
+
+    bool parseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const bool has_value = i + 1 < argc;
+            if (std::strcmp(argv[i], "--rate") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.rate))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--divisor") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.divisor))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--coning") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.pipeline.coning))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--earth") == 0 && has_value && std::strcmp(argv[i + 1], "wgs84") == 0)
+            {
+                options.pipeline.earth = strapdown::EarthModel::Wgs84;
+                ++i;
+            }
+            else if (std::strcmp(argv[i], "--earth") == 0 && has_value && std::strcmp(argv[i + 1], "sphere") == 0)
+            {
+                options.pipeline.earth = strapdown::EarthModel::Sphere;
+                ++i;
+            }
+            else if (std::strcmp(argv[i], "--normalization") == 0 && has_value && std::strcmp(argv[i + 1], "first-order") == 0)
+            {
+                options.pipeline.normalization = strapdown::Normalizer::FirstOrder;
+                ++i;
+            }
+            else if (std::strcmp(argv[i], "--normalization") == 0 && has_value && std::strcmp(argv[i + 1], "exact") == 0)
+            {
+                options.pipeline.normalization = strapdown::Normalizer::Exact;
+                ++i;
+            }
+            else if (std::strcmp(argv[i], "--r-compatible") == 0)
+            {
+                options.pipeline.coriolis = strapdown::CoriolisTerm::Reference;
+            }
+            else if (std::strcmp(argv[i], "--inaccuracies") == 0)
+            {
+                options.inaccuracies = true;
+            }
+            else if (std::strcmp(argv[i], "--open-loop") == 0)
+            {
+                options.open_loop = true;
+            }
+            else if (std::strcmp(argv[i], "--time") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.time))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--every") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.every))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--batch") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.batch))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+            {
+                if (!arguments::parse(argv[++i], options.seed))
+                {
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--compare") == 0 && has_value)
+            {
+                options.compare = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--output") == 0 && has_value)
+            {
+                options.output = argv[++i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        const strapdown::Pipeline &pipeline = options.pipeline;
+        return options.rate > 0. && pipeline.coning >= 1 && pipeline.coning <= 4 && options.divisor > 0 && options.divisor % pipeline.coning == 0 && options.time >= 0. && options.every > 0
+            && (options.batch == 0 || (pipeline.coning == 1 && !options.open_loop))
+            && (options.batch == 0 || options.compare.empty())
+            && (options.compare.empty() || pipeline.coriolis == strapdown::CoriolisTerm::Reference);
+    }
+
+    void writeOutputs(std::ostream &out, const strapdown::Navigation &nav)
+    {
+        out << nav.theta << "," << nav.gamma << "," << nav.psi << "," << nav.heading << ","
+            << nav.v_n << "," << nav.v_e << "," << nav.phi << "," << nav.lambda << "," << nav.eps << "\n";
+    }
+
+    void writeRow(std::ostream &out, double t, const strapdown::Navigation &nav)
+    {
+        out << t << ",";
+        writeOutputs(out, nav);
+    }
+
+    constexpr std::size_t columns = 9;
+
+    const char *columnNames[columns] = { "theta", "gamma", "psi", "heading", "V_N", "V_E", "phi", "lambda", "eps" };
+
+    // Tolerances of --compare: a value passes within absolute + relative *
+    // |reference|. The absolute bounds, rad and m/s, sit well under the size
+    // of the columns: the run is at rest, its speeds are rounding noise of
+    // about 2e-12 m/s and eps stays below 3e-16 rad. The relative term
+    // covers the 15 significant digits write.csv keeps.
+    //
+    // Only reference/navigation_10hz_port.csv is checked in. It comes from a
+    // double-precision Python transliteration of the R loop, not from R; the
+    // engine matches it to 5e-16 m/s and 4e-17 rad. The bounds have not been
+    // checked against an R run; knitting hw/main.Rmd writes
+    // reference/navigation_10hz_r.csv for that.
+    const double tolerances[columns] = { 1e-15, 1e-15, 1e-16, 1e-16, 1e-14, 1e-14, 1e-15, 1e-15, 1e-17 };
+    constexpr double relative_tolerance = 1e-14;
+
+    std::array<double, columns> values(const strapdown::Navigation &nav)
+    {
+        return { nav.theta, nav.gamma, nav.psi, nav.heading, nav.v_n, nav.v_e, nav.phi, nav.lambda, nav.eps };
+    }
+
+    // Rows of a reference CSV by step number; the header line, quoted by
+    // write.csv or not, is skipped
+    bool readReference(const std::string &path, double rate, std::map<std::size_t, std::array<double, columns>> &rows)
+    {
+        std::ifstream in(path);
+        std::string line;
+        if (!std::getline(in, line))
+        {
+            return false;
+        }
+        while (std::getline(in, line))
+        {
+            const char *cursor = line.c_str();
+            char *end = nullptr;
+            const double t = std::strtod(cursor, &end);
+            std::array<double, columns> row;
+            for (double &value : row)
+            {
+                if (*end != ',')
+                {
+                    return false;
+                }
+                value = std::strtod(end + 1, &end);
+            }
+            rows[static_cast<std::size_t>(std::llround(t * rate))] = row;
+        }
+        return !rows.empty();
+    }
+
+    // Largest absolute difference per column over the reference rows, and
+    // whether every row is within its tolerance
+    int compareRun(const strapdown::Scenario &scenario, const Options &options)
+    {
+        std::map<std::size_t, std::array<double, columns>> reference;
+        if (!readReference(options.compare, options.rate, reference))
+        {
+            std::cerr << "Cannot read reference " << options.compare << std::endl;
+            return 1;
+        }
+
+        std::array<double, columns> deviation {};
+        std::array<bool, columns> within;
+        within.fill(true);
+        std::size_t matched = 0;
+        const auto check = [&](std::size_t step, const strapdown::Navigation &nav)
+        {
+            const auto row = reference.find(step);
+            if (row == reference.end())
+            {
+                return;
+            }
+            const std::array<double, columns> computed = values(nav);
+            for (std::size_t k = 0; k < columns; ++k)
+            {
+                const double difference = std::abs(computed[k] - row->second[k]);
+                deviation[k] = std::max(deviation[k], difference);
+                within[k] = within[k] && difference <= tolerances[k] + relative_tolerance * std::abs(row->second[k]);
+            }
+            ++matched;
+        };
+
+        check(0, strapdown::Engine<>(scenario.config()).navigation());
+        strapdown::simulate(scenario, options.pipeline, reference.rbegin()->first, check);
+
+        bool passed = matched == reference.size();
+        std::cout << "Compared " << matched << " of " << reference.size() << " reference rows" << std::endl;
+        for (std::size_t k = 0; k < columns; ++k)
+        {
+            passed = passed && within[k];
+            std::cout << "  " << columnNames[k] << ": max |difference| " << deviation[k] << ", tolerance " << tolerances[k] << " + " << relative_tolerance
+                      << " |reference|" << (within[k] ? "" : "  FAILED") << std::endl;
+        }
+        std::cout << (passed ? "Reference matched" : "Reference NOT matched") << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    // Latitude within +-80 deg, any azimuth, turn axes in turn; bias and
+    // drift up to the scenario's values, or zero without its inaccuracies
+    std::vector<StrapdownVariant> sweep(const strapdown::Scenario &scenario, std::size_t count, std::uint64_t seed)
+    {
+        constexpr double deg = 3.14159265358979323846 / 180.;
+        const philox::Stream stream(seed, 0);
+        std::vector<StrapdownVariant> variants(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            variants[i].phi_0 = (160. * stream.uniform(4 * i) - 80.) * deg;
+            variants[i].eps_0 = 360. * stream.uniform(4 * i + 1) * deg;
+            if (scenario.inaccuracies)
+            {
+                variants[i].bias = scenario.bias * stream.uniform(4 * i + 2);
+                variants[i].drift = scenario.drift * stream.uniform(4 * i + 3);
+            }
+            variants[i].axis = i % 3;
+        }
+        return variants;
+    }
+
+    // One row per trajectory: its parameters and final outputs
+    template <typename Batch>
+    void writeSweep(const strapdown::Scenario &scenario, std::size_t steps, const Options &options, std::ostream &out)
+    {
+        const std::vector<StrapdownVariant> variants = sweep(scenario, options.batch, options.seed);
+        Batch batch(scenario, variants);
+        ThreadPool pool;
+
+        const auto start = std::chrono::steady_clock::now();
+        batch.run(steps, pool);
+        const auto stop = std::chrono::steady_clock::now();
+
+        out << "variant,phi_0,eps_0,bias,drift,axis,theta,gamma,psi,heading,V_N,V_E,phi,lambda,eps\n";
+        for (std::size_t i = 0; i < variants.size(); ++i)
+        {
+            const StrapdownVariant &variant = variants[i];
+            out << i << "," << variant.phi_0 << "," << variant.eps_0 << "," << variant.bias << "," << variant.drift << "," << variant.axis << ",";
+            writeOutputs(out, batch.navigation(i));
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        std::cout << "Wrote " << options.output << ": " << variants.size() << " trajectories x " << steps << " steps in " << ms << " ms ("
+                  << variants.size() * steps / ms * 1e3 << " trajectory-steps/s, " << simd::Pack::width << " lanes, " << pool.size() << " threads)" << std::endl;
+    }
+}
+
+// Strapdown navigation run of the homework scenario, columns as the R variables
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    strapdown::Scenario scenario;
+    scenario.rate = options.rate;
+    scenario.divisor = options.divisor;
+    scenario.closed_loop = !options.open_loop;
+    scenario.inaccuracies = options.inaccuracies;
+    const std::size_t steps = static_cast<std::size_t>(options.time * options.rate + 0.5);
+
+    std::cout << "Coriolis sum: " << (options.pipeline.coriolis == strapdown::CoriolisTerm::Reference ? "reference, no h_N3 factor (R-compatible)" : "integrated over h_N3") << std::endl;
+
+    if (!options.compare.empty())
+    {
+        return compareRun(scenario, options);
+    }
+
+    std::ofstream out(options.output);
+    if (!out)
+    {
+        std::cerr << "Cannot open " << options.output << " for writing" << std::endl;
+        return 1;
+    }
+    out.precision(17);
+
+    if (options.batch > 0)
+    {
+        // Same policies as the single run; the sweep has no coning stage
+        strapdown::visit(scenario, options.pipeline, [&](auto policies)
+        {
+            using Selected = decltype(policies);
+            if constexpr (Selected::coning_samples == 1)
+            {
+                writeSweep<BatchStrapdown<typename Selected::earth_model, typename Selected::normalization_method, typename Selected::coriolis_sum,
+                    typename Selected::sensor_errors>>(
+                    scenario, steps, options, out);
+            }
+        });
+        return 0;
+    }
+
+    out << "t,theta,gamma,psi,heading,V_N,V_E,phi,lambda,eps\n";
+    writeRow(out, 0., strapdown::Engine<>(scenario.config()).navigation());
+
+    const auto sink = [&](std::size_t step, const strapdown::Navigation &nav)
+    {
+        if (step % options.every == 0)
+        {
+            writeRow(out, step / options.rate, nav);
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    strapdown::simulate(scenario, options.pipeline, steps, sink);
+    const auto stop = std::chrono::steady_clock::now();
+
+    const double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    std::cout << "Wrote " << options.output << ": " << steps << " steps in " << ms << " ms ("
+              << steps / ms * 1e3 << " steps/s)" << std::endl;
+    return 0;
+}
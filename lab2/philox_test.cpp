@@ -0,0 +1,68 @@
+#include "philox.h"
+
+#include <cstdio>
+#include <vector>
+
+// Philox4x32-10 known-answer vectors from Random123 (kat_vectors), then
+// the stream layout: fills at any offset match the per-step values
+namespace
+{
+    struct Known
+    {
+        philox::Counter ctr;
+        philox::Key key;
+        philox::Counter expected;
+    };
+
+    const Known known[] = {
+        { { 0x00000000, 0x00000000, 0x00000000, 0x00000000 }, { 0x00000000, 0x00000000 }, { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+        { { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff }, { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+        { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }, { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+    };
+}
+
+int main()
+{
+    bool passed = true;
+
+    for (const Known &k : known)
+    {
+        const philox::Counter r = philox::generate(k.ctr, k.key);
+        const bool ok = r == k.expected;
+        std::printf("%s KAT %08x %08x: %08x %08x %08x %08x\n", ok ? "ok  " : "FAIL", k.key[0], k.key[1], r[0], r[1], r[2], r[3]);
+        passed &= ok;
+    }
+
+    // Leading and trailing partial blocks, a block-aligned start and an empty fill
+    const philox::Stream stream(0x123456789abcdefULL, 42);
+    for (const std::uint64_t first : { 0, 1, 3, 4, 4097 })
+    {
+        for (const std::size_t count : { 0, 1, 2, 5, 8, 103 })
+        {
+            std::vector<double> values(count + 1, -1.);
+            stream.fillUniform(first, values.data(), count);
+            bool ok = values[count] == -1.;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                ok &= values[i] == stream.uniform(first + i) && values[i] > 0. && values[i] < 1.;
+            }
+            if (!ok)
+            {
+                std::printf("FAIL fillUniform(%llu, %zu) differs from uniform()\n", static_cast<unsigned long long>(first), count);
+            }
+            passed &= ok;
+        }
+    }
+
+    // Step 4 * i + j of run r is word j of the block with counter (i, r)
+    const philox::Counter block = philox::generate({ 5, 0, 42, 0 }, { 0x89abcdef, 0x01234567 });
+    bool layout = true;
+    for (std::size_t j = 0; j < philox::Stream::block; ++j)
+    {
+        layout &= stream.uniform(4 * 5 + j) == philox::toUniform(block[j]);
+    }
+    std::printf("%s stream layout\n", layout ? "ok  " : "FAIL");
+    passed &= layout;
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,390 @@
+#include "plotbuilder.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Min/max spans of the preview shown while a series loads
+    constexpr std::size_t preview_buckets = 2048;
+
+    // Points per background chunk, a multiple of the pyramid's finest bucket
+    constexpr std::size_t chunk_size = std::size_t(1) << 16;
+}
+
+PlotBuilder::PlotBuilder(const std::array<QCustomPlot *, 3> &plots)
+    : plots(plots)
+{
+    // Title rows stay in the layout, views only change their text
+    for (std::size_t k = 0; k < plots.size(); ++k)
+    {
+        plots[k]->plotLayout()->insertRow(0);
+        titles[k] = new QCPTextElement(plots[k], "", QFont("Arial", 12, QFont::Bold));
+        plots[k]->plotLayout()->addElement(0, 0, titles[k]);
+    }
+}
+
+PlotBuilder::~PlotBuilder()
+{
+    stopLoads();
+    {
+        const std::lock_guard<std::mutex> lock(loader_mutex);
+        loader_stopping = true;
+    }
+    loader_wake.notify_one();
+    if (loader.joinable())
+    {
+        loader.join();
+    }
+}
+
+void PlotBuilder::assign(const Solution &solution, Solution::Stage stage)
+{
+    switch (stage)
+    {
+    case Solution::Stage::Simulation:
+        x = solution.x.view();
+        z = solution.z.view();
+        t = solution.t.toQtVector();
+        break;
+    case Solution::Stage::Filters:
+        x_err = solution.x_err.view();
+        x_err_pmin = solution.x_err_pmin.view();
+        x_err_pmax = solution.x_err_pmax.view();
+        x_err_rmin = solution.x_err_rmin.view();
+        x_err_rmax = solution.x_err_rmax.view();
+        x_err_qmin = solution.x_err_qmin.view();
+        x_err_qmax = solution.x_err_qmax.view();
+        break;
+    case Solution::Stage::Long:
+        x_err_long = solution.x_err_long.view();
+        break;
+    case Solution::Stage::Short:
+        x_err_short = solution.x_err_short.view();
+        break;
+    default:
+        break;
+    }
+}
+
+void PlotBuilder::show(const plotview::View &view)
+{
+    for (std::size_t k = 0; k < plots.size(); ++k)
+    {
+        QCustomPlot *plot = plots[k];
+        const plotview::Plot &spec = view.plots[k];
+        const plotview::Axis &axis = plotview::axes()[k];
+        const int used = view.live ? 0 : static_cast<int>(spec.series.size());
+
+        // Graphs only ever get added; the ones this view does not need are hidden
+        while (plot->graphCount() < used)
+        {
+            addLodGraph(plot);
+        }
+        for (int i = 0; i < plot->graphCount(); ++i)
+        {
+            QCPGraph *graph = plot->graph(i);
+            if (i >= used)
+            {
+                graph->setVisible(false);
+                graph->removeFromLegend();
+                continue;
+            }
+
+            const plotview::Series &series = spec.series[static_cast<std::size_t>(i)];
+            graph->setVisible(true);
+            graph->setPen(QPen(series.color));
+            graph->setName(series.name);
+            graph->addToLegend();
+
+            const PlotData data = lookup({ series.source, k });
+            if (LodGraph *lod = qobject_cast<LodGraph *>(graph))
+            {
+                lod->setData(data.data, data.pyramid);
+            }
+            else
+            {
+                graph->setData(data.data);
+            }
+            graph->rescaleAxes(i > 0);
+        }
+
+        plot->legend->setVisible(spec.series.size() > 1);
+        plot->xAxis->setLabel("t, c");
+        plot->yAxis->setLabel(axis.label);
+        titles[k]->setText(spec.title);
+
+        // The live window scrolls by itself, dragging would fight it
+        plot->setInteractions(view.live ? QCP::iSelectPlottables : QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectPlottables);
+    }
+}
+
+void PlotBuilder::prefetch(const std::vector<plotview::View> &views, ThreadPool &pool)
+{
+    // Entries are created up front, so the jobs only write their own entry
+    std::vector<std::pair<Key, PlotData *>> missing;
+    for (const plotview::View &view : views)
+    {
+        for (std::size_t k = 0; k < view.plots.size() && !view.live; ++k)
+        {
+            for (const plotview::Series &series : view.plots[k].series)
+            {
+                const Key key(series.source, k);
+                if (cache.find(key) == cache.end() && pending.find(key) == pending.end())
+                {
+                    missing.emplace_back(key, &cache[key]);
+                }
+            }
+        }
+    }
+
+    pool.parallelFor(missing.size(), [this, &missing](std::size_t i)
+    {
+        *missing[i].second = build(column(missing[i].first.first, missing[i].first.second));
+    });
+}
+
+void PlotBuilder::clear()
+{
+    stopLoads();
+    cache.clear();
+}
+
+PlotBuilder::Column PlotBuilder::column(plotview::Source source, std::size_t plot) const
+{
+    Column result;
+    result.row = plot;
+    result.scale = plotview::axes()[plot].scale;
+    switch (source)
+    {
+    case plotview::Source::Truth:
+        result.states = x;
+        break;
+    case plotview::Source::Measurements:
+        result.scalar = z;
+        break;
+    case plotview::Source::Estimate:
+        result.states = x_err;
+        break;
+    case plotview::Source::Pmin:
+        result.states = x_err_pmin;
+        break;
+    case plotview::Source::Pmax:
+        result.states = x_err_pmax;
+        break;
+    case plotview::Source::Rmin:
+        result.states = x_err_rmin;
+        break;
+    case plotview::Source::Rmax:
+        result.states = x_err_rmax;
+        break;
+    case plotview::Source::Qmin:
+        result.states = x_err_qmin;
+        break;
+    case plotview::Source::Qmax:
+        result.states = x_err_qmax;
+        break;
+    case plotview::Source::Long:
+        result.states = x_err_long;
+        break;
+    case plotview::Source::Short:
+        result.states = x_err_short;
+        break;
+    }
+    return result;
+}
+
+PlotBuilder::PlotData PlotBuilder::build(const Column &values) const
+{
+    // Time is increasing, so the container can skip its sort
+    QVector<QCPGraphData> points(static_cast<int>(values.size()));
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        points[static_cast<int>(i)] = QCPGraphData(t[static_cast<int>(i)], values[i]);
+    }
+
+    PlotData result;
+    result.data.reset(new QCPGraphDataContainer);
+    result.data->set(points, true);
+    result.pyramid = std::make_shared<const LodPyramid>(*result.data);
+    return result;
+}
+
+PlotBuilder::PlotData PlotBuilder::lookup(const Key &key)
+{
+    const auto cached = cache.find(key);
+    if (cached != cache.end())
+    {
+        return cached->second;
+    }
+
+    if (!progressive)
+    {
+        return cache[key] = build(column(key.first, key.second));
+    }
+
+    if (pending.find(key) == pending.end())
+    {
+        startLoad(key);
+    }
+    return { pending[key].data, nullptr };
+}
+
+void PlotBuilder::startLoad(const Key &key)
+{
+    const Column values = column(key.first, key.second);
+    const std::size_t n = values.size();
+
+    Pending &load = pending[key];
+    load.id = ++next_load;
+
+    // Preview: both extremes of every span, in key order, so no spike is lost
+    const std::size_t span = std::max<std::size_t>(1, (n + preview_buckets - 1) / preview_buckets);
+    load.preview.reserve(static_cast<int>(2 * preview_buckets));
+    for (std::size_t first = 0; first < n; first += span)
+    {
+        const std::size_t last = std::min(first + span, n);
+        std::size_t lo = first;
+        std::size_t hi = first;
+        for (std::size_t i = first + 1; i < last; ++i)
+        {
+            lo = values[i] < values[lo] ? i : lo;
+            hi = values[i] > values[hi] ? i : hi;
+        }
+        load.preview.append(QCPGraphData(t[static_cast<int>(std::min(lo, hi))], values[std::min(lo, hi)]));
+        if (lo != hi)
+        {
+            load.preview.append(QCPGraphData(t[static_cast<int>(std::max(lo, hi))], values[std::max(lo, hi)]));
+        }
+    }
+    load.data.reset(new QCPGraphDataContainer);
+    load.data->set(load.preview, true);
+
+    // The full data is built off the GUI thread and handed over chunk by chunk
+    load.cancel = std::make_shared<std::atomic<bool>>(false);
+    {
+        const std::lock_guard<std::mutex> lock(loader_mutex);
+        jobs.push_back({ key, load.id, values, t, plots[key.second], load.cancel });
+        if (!loader.joinable())
+        {
+            loader = std::thread(&PlotBuilder::runLoader, this);
+        }
+    }
+    loader_wake.notify_one();
+}
+
+void PlotBuilder::runLoader()
+{
+    std::unique_lock<std::mutex> lock(loader_mutex);
+    for (;;)
+    {
+        loader_wake.wait(lock, [this]() { return loader_stopping || !jobs.empty(); });
+        if (loader_stopping)
+        {
+            return;
+        }
+
+        // Newest first: the view on screen before the ones switched away from
+        const Job job = std::move(jobs.back());
+        jobs.pop_back();
+        lock.unlock();
+        load(job);
+        lock.lock();
+    }
+}
+
+void PlotBuilder::load(const Job &job)
+{
+    const std::size_t n = job.values.size();
+    std::vector<LodPyramid::Bucket> finest;
+    for (std::size_t first = 0; first < n; first += chunk_size)
+    {
+        if (*job.cancel)
+        {
+            return;
+        }
+
+        const std::size_t last = std::min(first + chunk_size, n);
+        QVector<QCPGraphData> chunk(static_cast<int>(last - first));
+        for (std::size_t i = first; i < last; ++i)
+        {
+            chunk[static_cast<int>(i - first)] = QCPGraphData(job.keys[static_cast<int>(i)], job.values[i]);
+        }
+        LodPyramid::appendFinest(chunk.constData(), chunk.constData() + chunk.size(), finest);
+        QMetaObject::invokeMethod(job.context, [this, key = job.key, id = job.id, chunk]() { appendChunk(key, id, chunk); }, Qt::QueuedConnection);
+    }
+
+    const std::shared_ptr<const LodPyramid> pyramid = std::make_shared<const LodPyramid>(std::move(finest));
+    QMetaObject::invokeMethod(job.context, [this, key = job.key, id = job.id, pyramid]() { finishLoad(key, id, pyramid); }, Qt::QueuedConnection);
+}
+
+void PlotBuilder::appendChunk(const Key &key, std::uint64_t id, const QVector<QCPGraphData> &chunk)
+{
+    const auto it = pending.find(key);
+    if (it == pending.end() || it->second.id != id || chunk.isEmpty())
+    {
+        return;
+    }
+    Pending &load = it->second;
+
+    // Drop the preview behind the full points, append the chunk, then the rest of the preview
+    if (load.loaded_any)
+    {
+        load.data->removeAfter(load.loaded_key);
+    }
+    else
+    {
+        load.data->clear();
+    }
+    load.data->add(chunk, true);
+    load.loaded_key = chunk.last().key;
+    load.loaded_any = true;
+
+    const auto tail = std::upper_bound(load.preview.constBegin(), load.preview.constEnd(), load.loaded_key, [](double key, const QCPGraphData &point)
+    {
+        return key < point.key;
+    });
+    load.data->add(load.preview.mid(static_cast<int>(tail - load.preview.constBegin())), true);
+
+    plots[key.second]->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void PlotBuilder::finishLoad(const Key &key, std::uint64_t id, std::shared_ptr<const LodPyramid> pyramid)
+{
+    const auto it = pending.find(key);
+    if (it == pending.end() || it->second.id != id)
+    {
+        return;
+    }
+
+    // The container is complete now, graphs still showing it get the pyramid
+    PlotData &data = cache[key];
+    data.data = it->second.data;
+    data.pyramid = std::move(pyramid);
+
+    QCustomPlot *plot = plots[key.second];
+    for (int i = 0; i < plot->graphCount(); ++i)
+    {
+        LodGraph *lod = qobject_cast<LodGraph *>(plot->graph(i));
+        if (lod && lod->data() == data.data)
+        {
+            lod->setData(data.data, data.pyramid);
+        }
+    }
+    plot->replot(QCustomPlot::rpQueuedReplot);
+
+    pending.erase(it);
+}
+
+void PlotBuilder::stopLoads()
+{
+    // The job in progress sees its flag at the next chunk; chunks it already
+    // queued to the GUI thread find no pending entry with their id and are dropped
+    for (auto &entry : pending)
+    {
+        *entry.second.cancel = true;
+    }
+    pending.clear();
+
+    const std::lock_guard<std::mutex> lock(loader_mutex);
+    jobs.clear();
+}
@@ -0,0 +1,152 @@
+#ifndef PLOTBUILDER_H
+#define PLOTBUILDER_H
+
+#include "lodgraph.h"
+#include "plotview.h"
+#include "solution.h"
+#include "threadpool.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Executes plotview specifications on a set of three plots. Keeps the
+// ready-to-plot data of every (source, plot) pair with its decimation pyramid,
+// built on first use or ahead of time by prefetch(), and shares it with the
+// graphs, so no view pays for a conversion twice. Used by MainWindow and by
+// the headless exporter.
+//
+// In progressive mode a series that is not cached yet is first shown as a
+// coarse min/max preview. One loader thread, shared by every series, then
+// builds the full data chunk by chunk, newest request first, and each chunk
+// replaces its part of the preview on the GUI thread.
+class PlotBuilder
+{
+public:
+    explicit PlotBuilder(const std::array<QCustomPlot *, 3> &plots);
+
+    // Stops the loader thread; call while the plots still exist
+    ~PlotBuilder();
+
+    void setProgressive(bool enabled) { progressive = enabled; }
+
+    // Takes views of the histories a finished stage has produced
+    void assign(const Solution &solution, Solution::Stage stage);
+
+    // Fills the plots, reusing their graphs; a live view only sets titles,
+    // labels and interactions and leaves the graphs hidden
+    void show(const plotview::View &view);
+
+    // Builds the cached data of every series in the views, one job per series
+    void prefetch(const std::vector<plotview::View> &views, ThreadPool &pool);
+
+    // Drops the cached data, e.g. before assigning another Solution
+    void clear();
+
+    const TrajectoryView<3> &states() const { return x; }
+    const TrajectoryView<1> &measurements() const { return z; }
+
+private:
+    using Key = std::pair<plotview::Source, std::size_t>;
+
+    struct PlotData
+    {
+        QSharedPointer<QCPGraphDataContainer> data;
+        std::shared_ptr<const LodPyramid> pyramid;
+    };
+
+    // One scaled state component, or the measurements
+    struct Column
+    {
+        TrajectoryView<3> states;
+        TrajectoryView<1> scalar;
+        std::size_t row = 0;
+        double scale = 1.;
+
+        std::size_t size() const { return scalar.empty() ? states.size() : scalar.size(); }
+        double operator[](std::size_t i) const { return (scalar.empty() ? states(row, i) : scalar(0, i)) * scale; }
+    };
+
+    // Series being loaded in the background. data holds the full points
+    // loaded so far followed by the part of the preview not yet replaced.
+    struct Pending
+    {
+        std::uint64_t id = 0;
+        QSharedPointer<QCPGraphDataContainer> data;
+        QVector<QCPGraphData> preview;
+        double loaded_key = 0.;
+        bool loaded_any = false;
+        std::shared_ptr<std::atomic<bool>> cancel;
+    };
+
+    // Full data of one series, built on the loader thread from its own
+    // references to the buffers, so clear() does not have to wait for it
+    struct Job
+    {
+        Key key;
+        std::uint64_t id;
+        Column values;
+        QVector<double> keys;
+        QCustomPlot *context;
+        std::shared_ptr<std::atomic<bool>> cancel;
+    };
+
+    const std::array<QCustomPlot *, 3> plots;
+    bool progressive = false;
+
+    // Title element above each plot, reused by every view
+    std::array<QCPTextElement *, 3> titles {};
+
+    // Views share the buffers of the Solution histories, nothing is copied
+    QVector<double> t;
+    TrajectoryView<3> x;
+    TrajectoryView<1> z;
+    TrajectoryView<3> x_err;
+    TrajectoryView<3> x_err_pmin;
+    TrajectoryView<3> x_err_pmax;
+    TrajectoryView<3> x_err_rmin;
+    TrajectoryView<3> x_err_rmax;
+    TrajectoryView<3> x_err_qmin;
+    TrajectoryView<3> x_err_qmax;
+    TrajectoryView<3> x_err_long;
+    TrajectoryView<3> x_err_short;
+
+    // Keyed by (source, plot index): the data depends on nothing else
+    std::map<Key, PlotData> cache;
+    std::map<Key, Pending> pending;
+    std::uint64_t next_load = 0;
+
+    // Started on the first load, stopped by the destructor
+    std::thread loader;
+    std::mutex loader_mutex;
+    std::condition_variable loader_wake;
+    std::vector<Job> jobs;
+    bool loader_stopping = false;
+
+    Column column(plotview::Source source, std::size_t plot) const;
+    PlotData build(const Column &values) const;
+
+    // Cached data, or in progressive mode the preview of a load it starts
+    PlotData lookup(const Key &key);
+    void startLoad(const Key &key);
+
+    // Loader thread side of a load
+    void runLoader();
+    void load(const Job &job);
+
+    // GUI thread side of a load
+    void appendChunk(const Key &key, std::uint64_t id, const QVector<QCPGraphData> &chunk);
+    void finishLoad(const Key &key, std::uint64_t id, std::shared_ptr<const LodPyramid> pyramid);
+
+    // Cancels the pending and queued loads, the loader thread keeps running
+    void stopLoads();
+};
+
+#endif // PLOTBUILDER_H
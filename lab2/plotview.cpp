@@ -0,0 +1,90 @@
+#include "plotview.h"
+#include "NumCpp.hpp"
+
+namespace plotview
+{
+    namespace
+    {
+        const std::array<QString, 3> quantities = { "Speed error", "Angle error", "Drift speed error" };
+        const std::array<QString, 3> titles = { "Speed measurement error", "Angle error", "Drift speed error" };
+
+        // True error against one estimate, the layout of most views
+        View estimateView(Source estimate, const QString &suffix)
+        {
+            View view;
+            for (std::size_t k = 0; k < view.plots.size(); ++k)
+            {
+                view.plots[k] = { titles[k] + suffix, {
+                    { Source::Truth, Qt::blue, quantities[k] },
+                    { estimate, Qt::red, quantities[k] + " estimation" },
+                } };
+            }
+            return view;
+        }
+
+        // Default estimate plus the runs with a parameter scaled down and up
+        View variantView(const QString &parameter, Source min, Source max)
+        {
+            View view = estimateView(Source::Estimate, " with various " + parameter);
+            for (std::size_t k = 0; k < view.plots.size(); ++k)
+            {
+                view.plots[k].series.push_back({ min, Qt::green, quantities[k] + " estimation with " + parameter + "min" });
+                view.plots[k].series.push_back({ max, Qt::black, quantities[k] + " estimation with " + parameter + "max" });
+            }
+            return view;
+        }
+
+        View simulationView()
+        {
+            View view;
+            view.plots[0] = { "Speed & Speed measurements errors", {
+                { Source::Truth, Qt::blue, quantities[0] },
+                { Source::Measurements, Qt::red, "Speed measurements error" },
+            } };
+            for (std::size_t k = 1; k < view.plots.size(); ++k)
+            {
+                view.plots[k] = { quantities[k], { { Source::Truth, Qt::blue, quantities[k] } } };
+            }
+            return view;
+        }
+
+        View liveView()
+        {
+            View view;
+            for (std::size_t k = 0; k < view.plots.size(); ++k)
+            {
+                view.plots[k] = { quantities[k] + " (live)", {
+                    { Source::Truth, Qt::blue, quantities[k] },
+                    { Source::Estimate, Qt::red, quantities[k] + " estimation" },
+                } };
+            }
+            view.live = true;
+            return view;
+        }
+    }
+
+    const std::array<Axis, 3> &axes()
+    {
+        static const std::array<Axis, 3> result = { {
+            { "δV, km/h", 3.6 },
+            { "Φ, deg", 180. / nc::constants::pi },
+            { "ω dr, deg/h", 180. / nc::constants::pi * 3600. },
+        } };
+        return result;
+    }
+
+    const std::vector<View> &views()
+    {
+        static const std::vector<View> result = {
+            simulationView(),
+            estimateView(Source::Estimate, ""),
+            variantView("P", Source::Pmin, Source::Pmax),
+            variantView("R", Source::Rmin, Source::Rmax),
+            variantView("Q", Source::Qmin, Source::Qmax),
+            estimateView(Source::Long, " with long estimation"),
+            estimateView(Source::Short, " with short estimation"),
+            liveView(),
+        };
+        return result;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef PLOTVIEW_H
+#define PLOTVIEW_H
+
+#include <QColor>
+#include <QString>
+
+#include <array>
+#include <vector>
+
+// Declarative description of the combo box views. Every view fills the three
+// plots (speed, angle, drift); a plot is a title plus a list of series drawn
+// from the Solution histories. MainWindow::showView() executes them.
+namespace plotview
+{
+    // Solution history a series is taken from
+    enum class Source
+    {
+        Truth,
+        Measurements,
+        Estimate,
+        Pmin,
+        Pmax,
+        Rmin,
+        Rmax,
+        Qmin,
+        Qmax,
+        Long,
+        Short,
+    };
+
+    struct Series
+    {
+        Source source;
+        Qt::GlobalColor color;
+        QString name;
+    };
+
+    struct Plot
+    {
+        QString title;
+        std::vector<Series> series;
+    };
+
+    struct View
+    {
+        std::array<Plot, 3> plots;
+
+        // Series come from the live stream instead of the cached histories
+        bool live = false;
+    };
+
+    // Quantity shown by one of the three plots, state component = plot index
+    struct Axis
+    {
+        QString label;
+        double scale;
+    };
+
+    const std::array<Axis, 3> &axes();
+
+    // In combo box order
+    const std::vector<View> &views();
+}
+
+#endif // PLOTVIEW_H
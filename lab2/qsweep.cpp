@@ -0,0 +1,104 @@
+#include "qsweep.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+QSweep::QSweep(const Trajectory<3> &x, const Trajectory<1> &z, const kalman::Model<3, 1> &model, const kalman::Matrix<3, 3> &p0, unsigned threads)
+    : x(x)
+    , z(z)
+    , model(model)
+    , p0(p0)
+    , filter(model.F, model.H)
+    , pool(threads)
+{
+}
+
+std::vector<QSweep::Candidate> QSweep::run(const std::vector<double> &q)
+{
+    constexpr std::size_t width = simd::Pack::width;
+    std::vector<Candidate> candidates(q.size());
+    pool.parallelFor((q.size() + width - 1) / width, [&](std::size_t block)
+    {
+        const std::size_t first = block * width;
+        evaluate(q, first, std::min(width, q.size() - first), candidates);
+    });
+    return candidates;
+}
+
+std::vector<double> QSweep::logGrid(double power_min, double power_max, std::size_t points)
+{
+    std::vector<double> q(points);
+    const double step = points > 1 ? (power_max - power_min) / static_cast<double>(points - 1) : 0.;
+    for (std::size_t i = 0; i < points; ++i)
+    {
+        q[i] = std::pow(10., power_min + step * static_cast<double>(i));
+    }
+    return q;
+}
+
+std::vector<QSweep::Candidate> QSweep::refine(double power_min, double power_max, std::size_t points, std::size_t levels)
+{
+    std::vector<Candidate> candidates;
+    std::vector<double> q = logGrid(power_min, power_max, points);
+    for (std::size_t level = 0; level < levels && !q.empty(); ++level)
+    {
+        // The bracket ends come from the previous level, run only the rest
+        std::vector<double> pending;
+        for (const double value : q)
+        {
+            if (std::none_of(candidates.begin(), candidates.end(), [value](const Candidate &candidate) { return candidate.q == value; }))
+            {
+                pending.push_back(value);
+            }
+        }
+        const std::vector<Candidate> grid = run(pending);
+        candidates.insert(candidates.end(), grid.begin(), grid.end());
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) { return a.q < b.q; });
+
+        // Zoom into the evaluated neighbours of the minimum, one step of the
+        // finest grid on either side, clipped to the first grid at its edges
+        const std::size_t i = best(candidates, 0);
+        const double q_min = candidates[i > 0 ? i - 1 : i].q;
+        const double q_max = candidates[i + 1 < candidates.size() ? i + 1 : i].q;
+        // Fewer than three points would only repeat the bracket ends
+        if (q_min == q_max || points < 3)
+        {
+            break;
+        }
+        q = logGrid(std::log10(q_min), std::log10(q_max), points);
+        q.front() = q_min;
+        q.back() = q_max;
+    }
+    return candidates;
+}
+
+std::size_t QSweep::best(const std::vector<Candidate> &candidates, std::size_t component)
+{
+    const auto it = std::min_element(candidates.begin(), candidates.end(), [component](const Candidate &a, const Candidate &b)
+    {
+        return a.stddev_err[component] < b.stddev_err[component];
+    });
+    return static_cast<std::size_t>(it - candidates.begin());
+}
+
+void QSweep::evaluate(const std::vector<double> &q, std::size_t first, std::size_t count, std::vector<Candidate> &candidates) const
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<BatchKalman<3>::Variant> variants(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        variants[i].p0 = p0;
+        variants[i].Q(2, 2) = q[first + i];
+        variants[i].R = model.R(0, 0);
+    }
+    const std::vector<std::array<double, 4>> err = filter.errors(variants, z, x);
+
+    const auto stop = std::chrono::steady_clock::now();
+    const double wall_time = std::chrono::duration<double, std::milli>(stop - start).count() / static_cast<double>(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        candidates[first + i] = { q[first + i], err[i], wall_time };
+    }
+}
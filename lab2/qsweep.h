@@ -0,0 +1,58 @@
+#ifndef QSWEEP_H
+#define QSWEEP_H
+
+#include "batchkalman.h"
+#include "kalman.h"
+#include "threadpool.h"
+#include "trajectory.h"
+
+#include <array>
+#include <vector>
+
+// Evaluates process noise candidates Q = q * diag(0, 0, 1) by running a full
+// filter pass per candidate. Candidates are independent: they are packed into
+// SIMD lanes and the lane blocks run on a pool.
+class QSweep
+{
+public:
+    struct Candidate
+    {
+        double q;
+
+        // Mean squared estimation error: summary, speed, angle and drift
+        std::array<double, 4> stddev_err;
+
+        // Wall time spent on this candidate, ms: its share of the lane block
+        double wall_time;
+    };
+
+    QSweep(const Trajectory<3> &x, const Trajectory<1> &z, const kalman::Model<3, 1> &model, const kalman::Matrix<3, 3> &p0, unsigned threads = std::thread::hardware_concurrency());
+
+    // Evaluates every q of the grid, results keep the grid order
+    std::vector<Candidate> run(const std::vector<double> &q);
+
+    // Log-spaced grid 10^power_min .. 10^power_max
+    static std::vector<double> logGrid(double power_min, double power_max, std::size_t points);
+
+    // Evaluates a log-spaced grid, then levels - 1 times narrows it to the
+    // evaluated neighbours of the best summary error, so each level spans two
+    // steps of the previous one. Bracket ends are not evaluated again.
+    // Returns every evaluated candidate sorted by q.
+    std::vector<Candidate> refine(double power_min, double power_max, std::size_t points, std::size_t levels);
+
+    // Index of the candidate with the smallest error for the given component
+    static std::size_t best(const std::vector<Candidate> &candidates, std::size_t component);
+
+private:
+    const Trajectory<3> &x;
+    const Trajectory<1> &z;
+    const kalman::Model<3, 1> model;
+    const kalman::Matrix<3, 3> p0;
+    const BatchKalman<3> filter;
+    ThreadPool pool;
+
+    // Evaluates q[first], ..., q[first + count - 1] in one lane block
+    void evaluate(const std::vector<double> &q, std::size_t first, std::size_t count, std::vector<Candidate> &candidates) const;
+};
+
+#endif // QSWEEP_H
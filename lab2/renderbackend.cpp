@@ -0,0 +1,109 @@
+#include "renderbackend.h"
+
+#ifdef QCUSTOMPLOT_USE_OPENGL
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#endif
+
+namespace renderbackend
+{
+    Backend fromEnvironment()
+    {
+        const QString value = qEnvironmentVariable("INS_RENDER_BACKEND").toLower();
+        if (value == "opengl")
+        {
+            return Backend::OpenGl;
+        }
+        if (value == "pixmap")
+        {
+            return Backend::Pixmap;
+        }
+        return Backend::Auto;
+    }
+
+    bool hardwareGlAvailable(QString *renderer)
+    {
+#ifdef QCUSTOMPLOT_USE_OPENGL
+        static const QString probed = []()
+        {
+            QOffscreenSurface surface;
+            surface.create();
+            QOpenGLContext context;
+            if (!context.create() || !context.makeCurrent(&surface))
+            {
+                return QString();
+            }
+            const QString name = reinterpret_cast<const char *>(context.functions()->glGetString(GL_RENDERER));
+            context.doneCurrent();
+            return name;
+        }();
+
+        if (renderer)
+        {
+            *renderer = probed;
+        }
+        const QString name = probed.toLower();
+        return !name.isEmpty() && !name.contains("llvmpipe") && !name.contains("softpipe") && !name.contains("swrast") && !name.contains("software");
+#else
+        if (renderer)
+        {
+            *renderer = "not built with QCUSTOMPLOT_USE_OPENGL";
+        }
+        return false;
+#endif
+    }
+
+    bool apply(QCustomPlot *plot, Backend backend)
+    {
+        const bool wanted = backend == Backend::OpenGl || (backend == Backend::Auto && hardwareGlAvailable());
+        if (plot->openGl() != wanted)
+        {
+            // setOpenGl() itself drops back to pixmaps if the context cannot be made
+            plot->setOpenGl(wanted);
+            plot->replot(QCustomPlot::rpQueuedReplot);
+        }
+        return plot->openGl();
+    }
+}
+
+FrameTimeOverlay::FrameTimeOverlay(QCustomPlot *plot)
+    : QObject(plot)
+    , plot(plot)
+{
+    plot->addLayer("frametime", plot->layer("legend"), QCustomPlot::limAbove);
+    layer = plot->layer("frametime");
+    layer->setMode(QCPLayer::lmBuffered);
+
+    text = new QCPItemText(plot);
+    text->setLayer(layer);
+    text->setClipToAxisRect(false);
+    text->position->setType(QCPItemPosition::ptAxisRectRatio);
+    text->position->setCoords(1., 0.);
+    text->setPositionAlignment(Qt::AlignTop | Qt::AlignRight);
+    text->setFont(QFont("Monospace", 9));
+    text->setColor(Qt::darkGray);
+
+    setVisible(false);
+    connect(plot, &QCustomPlot::afterReplot, this, &FrameTimeOverlay::onAfterReplot);
+}
+
+void FrameTimeOverlay::setVisible(bool visible)
+{
+    layer->setVisible(visible);
+    plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void FrameTimeOverlay::onAfterReplot()
+{
+    if (!layer->visible())
+    {
+        return;
+    }
+
+    text->setText(QString("%1: %2 ms, avg %3 ms")
+                  .arg(plot->openGl() ? "OpenGL" : "pixmap")
+                  .arg(plot->replotTime(false), 0, 'f', 1)
+                  .arg(plot->replotTime(true), 0, 'f', 1));
+    layer->replot();
+}
@@ -0,0 +1,53 @@
+#ifndef RENDERBACKEND_H
+#define RENDERBACKEND_H
+
+#include <QObject>
+#include <QString>
+#include "qcustomplot.h"
+
+// Choice between QCustomPlot's OpenGL framebuffer paint buffers and the
+// default pixmap ones. OpenGL is only used with a hardware renderer: software
+// rasterizers (Mesa llvmpipe/softpipe, swrast) are slower than QPainter on a
+// pixmap, so they count as no GL at all.
+namespace renderbackend
+{
+    enum class Backend
+    {
+        Auto,
+        OpenGl,
+        Pixmap,
+    };
+
+    // INS_RENDER_BACKEND=auto|opengl|pixmap, Auto when unset or unknown
+    Backend fromEnvironment();
+
+    // Probes for a hardware GL context once; renderer receives GL_RENDERER
+    bool hardwareGlAvailable(QString *renderer = nullptr);
+
+    // Switches the plot's paint buffers and replots. Returns whether OpenGL is
+    // active afterwards, falling back to pixmaps when it cannot be set up.
+    bool apply(QCustomPlot *plot, Backend backend);
+}
+
+// Frame time of the last and of the averaged replots in the top-right corner
+// of a plot. It sits on its own buffered layer, so refreshing the text after
+// a replot redraws that layer only and does not trigger another replot.
+class FrameTimeOverlay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameTimeOverlay(QCustomPlot *plot);
+
+    void setVisible(bool visible);
+
+private slots:
+    void onAfterReplot();
+
+private:
+    QCustomPlot *plot;
+    QCPLayer *layer;
+    QCPItemText *text;
+};
+
+#endif // RENDERBACKEND_H
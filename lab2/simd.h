@@ -0,0 +1,92 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Packed doubles, one independent value per lane. The width follows the
+// instruction set enabled at compile time: AVX-512, AVX2 or plain scalar.
+namespace simd
+{
+#if defined(__AVX512F__)
+    struct Pack
+    {
+        static constexpr std::size_t width = 8;
+        __m512d v;
+
+        Pack() : v(_mm512_setzero_pd()) {}
+        Pack(double value) : v(_mm512_set1_pd(value)) {}
+        explicit Pack(__m512d value) : v(value) {}
+
+        static Pack load(const double *lanes) { return Pack(_mm512_loadu_pd(lanes)); }
+        void store(double *lanes) const { _mm512_storeu_pd(lanes, v); }
+
+        Pack &operator+=(const Pack &other) { v = _mm512_add_pd(v, other.v); return *this; }
+        Pack &operator-=(const Pack &other) { v = _mm512_sub_pd(v, other.v); return *this; }
+        Pack &operator*=(const Pack &other) { v = _mm512_mul_pd(v, other.v); return *this; }
+        Pack &operator/=(const Pack &other) { v = _mm512_div_pd(v, other.v); return *this; }
+    };
+#elif defined(__AVX2__)
+    struct Pack
+    {
+        static constexpr std::size_t width = 4;
+        __m256d v;
+
+        Pack() : v(_mm256_setzero_pd()) {}
+        Pack(double value) : v(_mm256_set1_pd(value)) {}
+        explicit Pack(__m256d value) : v(value) {}
+
+        static Pack load(const double *lanes) { return Pack(_mm256_loadu_pd(lanes)); }
+        void store(double *lanes) const { _mm256_storeu_pd(lanes, v); }
+
+        Pack &operator+=(const Pack &other) { v = _mm256_add_pd(v, other.v); return *this; }
+        Pack &operator-=(const Pack &other) { v = _mm256_sub_pd(v, other.v); return *this; }
+        Pack &operator*=(const Pack &other) { v = _mm256_mul_pd(v, other.v); return *this; }
+        Pack &operator/=(const Pack &other) { v = _mm256_div_pd(v, other.v); return *this; }
+    };
+#else
+    struct Pack
+    {
+        static constexpr std::size_t width = 1;
+        double v;
+
+        Pack() : v(0.) {}
+        Pack(double value) : v(value) {}
+
+        static Pack load(const double *lanes) { return Pack(*lanes); }
+        void store(double *lanes) const { *lanes = v; }
+
+        Pack &operator+=(const Pack &other) { v += other.v; return *this; }
+        Pack &operator-=(const Pack &other) { v -= other.v; return *this; }
+        Pack &operator*=(const Pack &other) { v *= other.v; return *this; }
+        Pack &operator/=(const Pack &other) { v /= other.v; return *this; }
+    };
+#endif
+
+    inline Pack operator+(Pack lhs, const Pack &rhs) { return lhs += rhs; }
+    inline Pack operator-(Pack lhs, const Pack &rhs) { return lhs -= rhs; }
+    inline Pack operator*(Pack lhs, const Pack &rhs) { return lhs *= rhs; }
+    inline Pack operator/(Pack lhs, const Pack &rhs) { return lhs /= rhs; }
+
+    // -0 - p flips the sign bit, zeros included
+    inline Pack operator-(const Pack &p) { return Pack(-0.) - p; }
+
+    // above(value, threshold): value in lanes where it exceeds threshold, 0 elsewhere
+
+#if defined(__AVX512F__)
+    inline Pack sqrt(const Pack &p) { return Pack(_mm512_sqrt_pd(p.v)); }
+    inline Pack above(const Pack &value, const Pack &threshold) { return Pack(_mm512_maskz_mov_pd(_mm512_cmp_pd_mask(value.v, threshold.v, _CMP_GT_OQ), value.v)); }
+#elif defined(__AVX2__)
+    inline Pack sqrt(const Pack &p) { return Pack(_mm256_sqrt_pd(p.v)); }
+    inline Pack above(const Pack &value, const Pack &threshold) { return Pack(_mm256_and_pd(_mm256_cmp_pd(value.v, threshold.v, _CMP_GT_OQ), value.v)); }
+#else
+    inline Pack sqrt(const Pack &p) { return Pack(std::sqrt(p.v)); }
+    inline Pack above(const Pack &value, const Pack &threshold) { return Pack(value.v > threshold.v ? value.v : 0.); }
+#endif
+}
+
+#endif // SIMD_H
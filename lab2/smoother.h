@@ -0,0 +1,296 @@
+#ifndef SMOOTHER_H
+#define SMOOTHER_H
+
+#include "kalman.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+// Rauch-Tung-Striebel fixed-interval smoother. The forward pass stores, per
+// step, the updated estimate, the updated covariance and the predicted one;
+// the backward pass turns them into smoothed estimates in linear time:
+//   C = P(k|k) F' P(k+1|k)^-1
+//   xs(k) = x(k|k) + C (xs(k+1) - F x(k|k))
+// Smoothed estimates are handed to a sink from the last step to the first,
+// so nothing of size n has to be kept by the caller either.
+template <std::size_t N, std::size_t M>
+class RtsSmoother
+{
+public:
+    using Measurement = std::function<kalman::Vector<M>(std::size_t)>;
+    using Sink = std::function<void(std::size_t, const kalman::Vector<N> &)>;
+
+    RtsSmoother(const kalman::Model<N, M> &model, const kalman::Vector<N> &x0, const kalman::Matrix<N, N> &p0)
+        : model(model)
+        , x0(x0)
+        , p0(p0)
+    {
+    }
+
+    // Keeps every forward record: in memory, or in a compact file at path
+    // (symmetric covariances packed, read back in chunks, removed afterwards)
+    void smooth(std::size_t steps, const Measurement &z, const Sink &sink, const std::string &path = {}) const
+    {
+        if (steps == 0)
+        {
+            return;
+        }
+        RecordStore store(path, steps);
+        forward(0, steps, first(), z, [&](std::size_t, const Record &record) { store.append(record); });
+
+        Record next = store.read(steps - 1);
+        kalman::Vector<N> xs = next.state.x;
+        sink(steps - 1, xs);
+        for (std::size_t k = steps - 1; k-- > 0;)
+        {
+            const Record current = store.read(k);
+            xs = backward(current, next, xs);
+            sink(k, xs);
+            next = current;
+        }
+    }
+
+    // For runs larger than memory: keeps a checkpoint every block steps (about
+    // sqrt(steps) by default) and recomputes each block forward from its
+    // checkpoint on the way back. Memory is O(steps / block + block).
+    void smoothCheckpointed(std::size_t steps, const Measurement &z, const Sink &sink, std::size_t block = 0) const
+    {
+        if (steps == 0)
+        {
+            return;
+        }
+        if (block == 0)
+        {
+            block = std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(static_cast<double>(steps))));
+        }
+
+        std::vector<Record> checkpoints;
+        forward(0, steps, first(), z, [&](std::size_t k, const Record &record)
+        {
+            if (k % block == 0)
+            {
+                checkpoints.push_back(record);
+            }
+        });
+
+        std::vector<Record> records;
+        Record next;
+        kalman::Vector<N> xs;
+        for (std::size_t b = checkpoints.size(); b-- > 0;)
+        {
+            const std::size_t begin = b * block;
+            const std::size_t end = std::min(begin + block, steps);
+
+            records.clear();
+            forward(begin, end, checkpoints[b], z, [&](std::size_t, const Record &record) { records.push_back(record); });
+
+            std::size_t k = end;
+            if (end == steps)
+            {
+                // Last step: the smoothed estimate is the filtered one
+                --k;
+                next = records[k - begin];
+                xs = next.state.x;
+                sink(k, xs);
+            }
+            while (k-- > begin)
+            {
+                const Record &current = records[k - begin];
+                xs = backward(current, next, xs);
+                sink(k, xs);
+                next = current;
+            }
+        }
+    }
+
+private:
+    // Forward output of one step
+    struct Record
+    {
+        kalman::State<N> state;       // x(k|k), P(k|k)
+        kalman::Matrix<N, N> p_pred;  // P(k|k-1)
+    };
+
+    static constexpr std::size_t packed_size = N + N * (N + 1);
+
+    // Records in memory, or packed into a binary file
+    class RecordStore
+    {
+    public:
+        RecordStore(const std::string &path, std::size_t steps) : path(path)
+        {
+            if (path.empty())
+            {
+                memory.reserve(steps);
+                return;
+            }
+            file = std::fopen(path.c_str(), "w+b");
+            if (file == nullptr)
+            {
+                throw std::runtime_error("Cannot open smoother buffer " + path);
+            }
+        }
+
+        ~RecordStore()
+        {
+            if (file != nullptr)
+            {
+                std::fclose(file);
+                std::remove(path.c_str());
+            }
+        }
+
+        RecordStore(const RecordStore &) = delete;
+        RecordStore &operator=(const RecordStore &) = delete;
+
+        void append(const Record &record)
+        {
+            if (file == nullptr)
+            {
+                memory.push_back(record);
+                return;
+            }
+            const std::array<double, packed_size> packed = pack(record);
+            if (std::fwrite(packed.data(), sizeof(double), packed_size, file) != packed_size)
+            {
+                throw std::runtime_error("Cannot write smoother buffer " + path);
+            }
+            ++count;
+        }
+
+        // Reads are expected to go backwards, so the chunk ends at index
+        Record read(std::size_t index)
+        {
+            if (file == nullptr)
+            {
+                return memory[index];
+            }
+            if (index < chunk_first || index >= chunk_first + chunk_size)
+            {
+                chunk_first = index + 1 >= chunk_records ? index + 1 - chunk_records : 0;
+                chunk_size = std::min(chunk_records, count - chunk_first);
+                chunk.resize(chunk_size * packed_size);
+                // Buffered write errors only show up here
+                if (std::fflush(file) != 0)
+                {
+                    throw std::runtime_error("Cannot write smoother buffer " + path);
+                }
+                seek(chunk_first * packed_size * sizeof(double));
+                if (std::fread(chunk.data(), sizeof(double) * packed_size, chunk_size, file) != chunk_size)
+                {
+                    throw std::runtime_error("Cannot read smoother buffer " + path);
+                }
+                std::fseek(file, 0, SEEK_END);
+            }
+            return unpack(chunk.data() + (index - chunk_first) * packed_size);
+        }
+
+    private:
+        static constexpr std::size_t chunk_records = 4096;
+
+        // 64-bit offsets: long is 32 bits on Windows and the file may pass 2 GiB
+        void seek(std::uint64_t offset)
+        {
+#ifdef _WIN32
+            const int status = _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+            const int status = fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+            if (status != 0)
+            {
+                throw std::runtime_error("Cannot seek in smoother buffer " + path);
+            }
+        }
+
+        const std::string path;
+        std::vector<Record> memory;
+        std::FILE *file = nullptr;
+        std::size_t count = 0;
+
+        std::vector<double> chunk;
+        std::size_t chunk_first = 0;
+        std::size_t chunk_size = 0;
+    };
+
+    const kalman::Model<N, M> model;
+    const kalman::Vector<N> x0;
+    const kalman::Matrix<N, N> p0;
+
+    Record first() const
+    {
+        return { { x0, p0 }, p0 };
+    }
+
+    // Runs the filter over steps begin + 1 .. end - 1 starting from the
+    // record of step begin, reporting every record including the first
+    template <typename Output>
+    void forward(std::size_t begin, std::size_t end, const Record &start, const Measurement &z, Output &&output) const
+    {
+        Record record = start;
+        output(begin, record);
+        for (std::size_t k = begin + 1; k < end; ++k)
+        {
+            kalman::predict(model, record.state);
+            record.p_pred = record.state.p;
+            kalman::update(model, record.state, z(k));
+            output(k, record);
+        }
+    }
+
+    kalman::Vector<N> backward(const Record &current, const Record &next, const kalman::Vector<N> &xs_next) const
+    {
+        const kalman::Matrix<N, N> C = current.state.p * kalman::transpose(model.F) * kalman::inverse(next.p_pred);
+        return current.state.x + C * (xs_next - model.F * current.state.x);
+    }
+
+    static std::array<double, packed_size> pack(const Record &record)
+    {
+        std::array<double, packed_size> packed;
+        std::size_t i = 0;
+        for (std::size_t r = 0; r < N; ++r)
+        {
+            packed[i++] = record.state.x[r];
+        }
+        for (std::size_t r = 0; r < N; ++r)
+        {
+            for (std::size_t c = r; c < N; ++c)
+            {
+                packed[i++] = record.state.p(r, c);
+                packed[i++] = record.p_pred(r, c);
+            }
+        }
+        return packed;
+    }
+
+    static Record unpack(const double *packed)
+    {
+        Record record;
+        std::size_t i = 0;
+        for (std::size_t r = 0; r < N; ++r)
+        {
+            record.state.x[r] = packed[i++];
+        }
+        for (std::size_t r = 0; r < N; ++r)
+        {
+            for (std::size_t c = r; c < N; ++c)
+            {
+                record.state.p(r, c) = record.state.p(c, r) = packed[i++];
+                record.p_pred(r, c) = record.p_pred(c, r) = packed[i++];
+            }
+        }
+        return record;
+    }
+};
+
+#endif // SMOOTHER_H
@@ -0,0 +1,114 @@
+#include "smoother.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Checkpointed and file-backed RTS passes against the in-memory one on the
+// Solution error model, with a drifting sawtooth as the measured speed
+namespace
+{
+    using Estimates = std::vector<kalman::Vector<3>>;
+
+    kalman::Model<3, 1> makeModel()
+    {
+        kalman::Model<3, 1> model;
+        model.F = kalman::Matrix<3, 3>::identity();
+        model.F(0, 1) = -9.81;
+        model.F(1, 0) = 1. / 6'371'300;
+        model.F(1, 2) = 1.;
+        model.H(0, 0) = 1.;
+        model.Q(2, 2) = 1e-14;
+        model.R(0, 0) = 0.01;
+        return model;
+    }
+
+    kalman::Vector<1> measurement(std::size_t k)
+    {
+        return { { 0.1 * static_cast<double>(k % 17) - 0.8 + 1e-4 * static_cast<double>(k) } };
+    }
+
+    Estimates collect(std::size_t steps, const std::function<void(const RtsSmoother<3, 1>::Sink &)> &pass)
+    {
+        Estimates result(steps);
+        std::vector<int> calls(steps, 0);
+        pass([&](std::size_t k, const kalman::Vector<3> &xs)
+        {
+            result[k] = xs;
+            ++calls[k];
+        });
+        for (std::size_t k = 0; k < steps; ++k)
+        {
+            if (calls[k] != 1)
+            {
+                std::cerr << "step " << k << " reported " << calls[k] << " times" << std::endl;
+                std::exit(1);
+            }
+        }
+        return result;
+    }
+
+    // Largest difference relative to the largest reference value, per component
+    double deviation(const Estimates &reference, const Estimates &other)
+    {
+        double worst = 0.;
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            double difference = 0.;
+            double range = 0.;
+            for (std::size_t k = 0; k < reference.size(); ++k)
+            {
+                difference = std::max(difference, std::abs(other[k][i] - reference[k][i]));
+                range = std::max(range, std::abs(reference[k][i]));
+            }
+            worst = std::max(worst, range > 0. ? difference / range : difference);
+        }
+        return worst;
+    }
+
+    bool check(const char *name, double value, double tolerance)
+    {
+        const bool passed = value <= tolerance;
+        std::cout << (passed ? "ok   " : "FAIL ") << name << ": " << value << std::endl;
+        return passed;
+    }
+}
+
+int main()
+{
+    const RtsSmoother<3, 1> smoother(makeModel(), kalman::Vector<3>(), kalman::Matrix<3, 3>::diagonal({ 1., 1e-6, 1e-12 }));
+    const std::size_t steps = 7201;
+
+    const Estimates memory = collect(steps, [&](const RtsSmoother<3, 1>::Sink &sink) { smoother.smooth(steps, measurement, sink); });
+
+    bool passed = true;
+
+    // Same forward arithmetic restarted from the checkpoints: bit-identical
+    for (const std::size_t block : { std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(100), steps - 1, steps, 2 * steps })
+    {
+        const Estimates checkpointed = collect(steps, [&](const RtsSmoother<3, 1>::Sink &sink) { smoother.smoothCheckpointed(steps, measurement, sink, block); });
+        passed &= check(("checkpointed, block " + std::to_string(block)).c_str(), deviation(memory, checkpointed), 0.);
+    }
+
+    // The file keeps one triangle of each covariance, so rounding may differ
+    const std::string path = "smoother_test.bin";
+    const Estimates file = collect(steps, [&](const RtsSmoother<3, 1>::Sink &sink) { smoother.smooth(steps, measurement, sink, path); });
+    passed &= check("file buffer", deviation(memory, file), 1e-12);
+    if (std::FILE *leftover = std::fopen(path.c_str(), "rb"))
+    {
+        std::fclose(leftover);
+        std::cerr << "file buffer " << path << " was not removed" << std::endl;
+        passed = false;
+    }
+
+    // Nothing to smooth, nothing reported
+    int calls = 0;
+    smoother.smooth(0, measurement, [&](std::size_t, const kalman::Vector<3> &) { ++calls; });
+    smoother.smoothCheckpointed(0, measurement, [&](std::size_t, const kalman::Vector<3> &) { ++calls; });
+    passed &= check("empty run calls", calls, 0);
+
+    return passed ? 0 : 1;
+}
@@ -1,24 +1,93 @@
 #include "solution.h"
+#include "batchkalman.h"
+#include "philox.h"
+#include "qsweep.h"
+#include "smoother.h"
 
-Solution::Solution()
+#include <chrono>
+#include <stdexcept>
+
+namespace
 {
+    const SolutionSettings &checked(const SolutionSettings &settings)
+    {
+        if (settings.q_points == 0 || settings.q_refine_levels == 0 || !(settings.q_power_min <= settings.q_power_max))
+        {
+            throw std::invalid_argument("Q sweep needs at least one point, one level and q_power_min <= q_power_max");
+        }
+        if (!settings.smoother_buffer.empty() && settings.smoother_checkpoints)
+        {
+            throw std::invalid_argument("Smoother buffer file and checkpoints are exclusive");
+        }
+        return settings;
+    }
+}
+
+Solution::Solution(std::uint64_t seed, const SolutionSettings &settings)
+    : seed(seed)
+    , settings(checked(settings))
+{
+    this->run();
+}
+
+Solution::Solution(Deferred, std::uint64_t seed, const SolutionSettings &settings)
+    : seed(seed)
+    , settings(checked(settings))
+{
+}
+
+void Solution::run(const StageCallback &finished)
+{
+    const auto report = [&finished](Stage stage) { return !finished || finished(stage); };
+
     this->generateWhiteNoise(n, constants::mu, constants::sigma);
     this->getSpeedErrors();
     this->getSpeedMeasurements();
+    if (!report(Stage::Simulation))
+    {
+        return;
+    }
+
     this->estimateOptimalQ();
+    if (!report(Stage::QSweep))
+    {
+        return;
+    }
+
     this->setupKalmanFilter();
-    this->setupKalmanFilterP();
-    this->setupKalmanFilterR();
-    this->setupKalmanFilterQ();
+    if (!report(Stage::Filters))
+    {
+        return;
+    }
+
+    this->setupKalmanFilterSteadyState();
+    if (!report(Stage::SteadyState))
+    {
+        return;
+    }
+
+    this->setupKalmanSmoother();
+    if (!report(Stage::Smoother))
+    {
+        return;
+    }
+
     this->setupKalmanFilterLong();
+    if (!report(Stage::Long))
+    {
+        return;
+    }
+
     this->setupKalmanFilterShort();
+    report(Stage::Short);
 }
 
 // 1.1. White noise simulation
 void Solution::generateWhiteNoise(nc::uint32 n, double mu, double sigma)
 {
-    // nc::random::seed(time(nullptr));
-    w = mu + nc::random::rand<double>(nc::Shape{ 1, n }) * sigma;
+    nc::NdArray<double> u(1, n);
+    philox::Stream(seed, 0).fillUniform(0, u.data(), n);
+    w = mu + u * sigma;
     w = w - nc::mean(w);
     w = w / sqrt(nc::var(w));
 }
@@ -26,316 +95,264 @@ void Solution::generateWhiteNoise(nc::uint32 n, double mu, double sigma)
 // 1.2. INS error simulation
 void Solution::getSpeedErrors()
 {
+    const Model model = makeModel(0., 0.);
+
     // Input noise matrix (continuous)
-    nc::NdArray<double> B = nc::transpose(nc::NdArray<double>({ 0, 0, 1 }));
+    const kalman::Vector<3> B = { {0}, {0}, {1} };
 
     // Input noise matrix (discrete)
-    const nc::NdArray<double> G = static_cast<double>(constants::T) * B;
+    const kalman::Vector<3> G = static_cast<double>(constants::T) * B;
 
-    for (int i = 0; i < n - 1; ++i)
+    x = Trajectory<3>(n);
+    x.setColumn(0, x0);
+    for (nc::uint32 i = 0; i < n - 1; ++i)
     {
-        x = nc::hstack({ x, nc::dot(F, x(x.rSlice(), i)) + 5e-08 * w[i] * G });
+        x.setColumn(i + 1, model.F * x.column(i) + constants::drift_noise * w[i] * G);
     }
 }
 
 // 1.3. Speed measurements simulation
 void Solution::getSpeedMeasurements()
 {
-    const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
+    const Model model = makeModel(0., 0.);
+    const double V = measurementNoise();
     std::cout << "Measurement noise = " << V << std::endl;
 
-    for (int i = 0; i < n; ++i)
+    z = Trajectory<1>(n);
+    for (nc::uint32 i = 0; i < n; ++i)
     {
-        z = nc::hstack({ z, nc::dot(H, x(x.rSlice(), i)) + w[i] * V });
+        z(0, i) = (model.H * x.column(i))[0] + w[i] * V;
     }
 }
 
 void Solution::estimateOptimalQ()
 {
-    const nc::NdArray<double> q_power = nc::linspace(-20., -1., 20);
-    std::array<double, 20> q;
-    for (int i = 0; i < q_power.size(); ++i)
-    {
-        q[i] = nc::powerf(10., q_power[i]);
-    }
-    nc::NdArray<double> stddev_err = nc::zeros<double>(nc::Shape{ 4, static_cast<nc::uint32>(q.size()) });
-
-    const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
+    const double V = measurementNoise();
     const double R = V * V;
 
-    nc::NdArray<double> p_diag;
-    for (int i = 0; i < 3; ++i)
-    {
-        p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-    }
-    const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-
     // Speed, angle and drift
-    for (int i = 0; i < q.size(); ++i)
-    {
-        nc::NdArray<double> p = p_diag * I;
-        const nc::NdArray<double> Q = q[i] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-        nc::NdArray<double> x_estimations = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
+    const auto start = std::chrono::steady_clock::now();
+    QSweep sweep(x, z, makeModel(0., R), initialCovariance());
+    const std::vector<QSweep::Candidate> candidates = sweep.refine(settings.q_power_min, settings.q_power_max, settings.q_points, settings.q_refine_levels);
+    const auto stop = std::chrono::steady_clock::now();
 
-        for (int j = 0; j < n - 1; ++j)
-        {
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-            x_estimations = nc::hstack({ x_estimations, nc::dot(F, x_estimations(x_estimations.rSlice(), j)) + K * (z(0, j + 1) - nc::dot(nc::dot(H, F), x_estimations(x_estimations.rSlice(), j))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
-            // Summary var
-            stddev_err(0, i) = stddev_err(0, i) + nc::sum( (x(x.rSlice(), j + 1) - x_estimations(x_estimations.rSlice(), j + 1)) * (x(x.rSlice(), j + 1) - x_estimations(x_estimations.rSlice(), j + 1)) )[0] / constants::simulation_time;
-            // Var for each component
-            stddev_err(1, i) = stddev_err(1, i) + ((x(0, j + 1) - x_estimations(0, j + 1)) * (x(0, j + 1) - x_estimations(0, j + 1))) / constants::simulation_time;
-            stddev_err(2, i) = stddev_err(2, i) + ((x(1, j + 1) - x_estimations(1, j + 1)) * (x(1, j + 1) - x_estimations(1, j + 1))) / constants::simulation_time;
-            stddev_err(3, i) = stddev_err(3, i) + ((x(2, j + 1) - x_estimations(2, j + 1)) * (x(2, j + 1) - x_estimations(2, j + 1))) / constants::simulation_time;
-        }
+    for (const QSweep::Candidate &candidate : candidates)
+    {
+        std::cout << "Q = " << candidate.q << ": " << candidate.wall_time << " ms" << std::endl;
     }
-
-    const size_t q_sum_min_index = nc::argmin(stddev_err(0, stddev_err.cSlice()))[0];
-    const size_t q_speed_min_index = nc::argmin(stddev_err(1, stddev_err.cSlice()))[0];
-    const size_t q_angle_min_index = nc::argmin(stddev_err(2, stddev_err.cSlice()))[0];
-    const size_t q_drift_min_index = nc::argmin(stddev_err(3, stddev_err.cSlice()))[0];
-    Q_optimal[0] = q[q_sum_min_index];
-    Q_optimal[1] = q[q_speed_min_index];
-    Q_optimal[2] = q[q_angle_min_index];
-    Q_optimal[3] = q[q_drift_min_index];
+    std::cout << "Q sweep: " << candidates.size() << " candidates in " << std::chrono::duration<double, std::milli>(stop - start).count() << " ms" << std::endl;
 
     for (int i = 0; i < Q_optimal.size(); ++i)
     {
-        std::cout << "Component #" << i << ": stddev = " << nc::min(stddev_err(i, stddev_err.cSlice()))[0] << ", optimal Q = " << Q_optimal[i] << std::endl;
+        const QSweep::Candidate &optimal = candidates[QSweep::best(candidates, i)];
+        Q_optimal[i] = optimal.q;
+        std::cout << "Component #" << i << ": stddev = " << optimal.stddev_err[i] << ", optimal Q = " << Q_optimal[i] << std::endl;
     }
 }
 
 // 2.2. Default Kalman Filter
+// 2.3. Kalman Filter with various P, R and Q
+// All seven runs share F, H and z, so they advance together in SIMD lanes
 void Solution::setupKalmanFilter()
 {
-    nc::NdArray<double> p_diag;
-    for (int i = 0; i < 3; ++i)
-    {
-        p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-    }
-
-    const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-    const nc::NdArray<double> Q = Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-    const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
+    const double V = measurementNoise();
     const double R = V * V;
-    nc::NdArray<double> p = p_diag * I;
-
-    for (int i = 0; i < n - 1; ++i)
-    {
-        const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-        const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-        x_err = nc::hstack({ x_err, nc::dot(F, x_err(x_err.rSlice(), i)) + K * (z(0, i + 1) - nc::dot(nc::dot(H, F), x_err(x_err.rSlice(), i))) });
-        p = nc::dot((I - nc::dot(K, H)), P);
-    }
+    const kalman::Matrix<3, 3> p0 = initialCovariance();
+    const Model model = makeModel(Q_optimal[0], R);
+    const kalman::Matrix<3, 3> Q = model.Q;
+
+    const std::vector<BatchKalman<3>::Variant> variants = {
+        { p0, Q, R },
+        { 0.01 * p0, Q, R },
+        { 100. * p0, Q, R },
+        { p0, Q, 0.01 * V * V },
+        { p0, Q, 100. * V * V },
+        { p0, 0.01 * Q, R },
+        { p0, 100. * Q, R },
+    };
+
+    std::vector<Trajectory<3>> estimates;
+    BatchKalman<3>(model.F, model.H).run(variants, z, estimates);
+
+    x_err = std::move(estimates[0]);
+    x_err_pmin = std::move(estimates[1]);
+    x_err_pmax = std::move(estimates[2]);
+    x_err_rmin = std::move(estimates[3]);
+    x_err_rmax = std::move(estimates[4]);
+    x_err_qmin = std::move(estimates[5]);
+    x_err_qmax = std::move(estimates[6]);
 }
 
-// 2.3. Kalman Filter with various P
-void Solution::setupKalmanFilterP()
+// 2.2. Default Kalman Filter with steady-state gain
+void Solution::setupKalmanFilterSteadyState()
 {
+    // Riccati fixed point, reached after as many steps as a filter started
+    // from the same covariance needs for its gain to settle
+    const double V = measurementNoise();
+    const kalman::SteadyState<3, 1> steady = kalman::steadyState(makeModel(Q_optimal[0], V * V), initialCovariance(), constants::steady_state_tolerance, n - 1);
+    const nc::uint32 steady_step = steady.converged ? static_cast<nc::uint32>(steady.iterations) : n - 1;
+
+    // Full recursion up to that step, the precomputed gain after it
+    KalmanFilter<3, 1> filter = makeFilter();
+    x_err_steady = Trajectory<3>(n);
+    for (nc::uint32 i = 0; i < n - 1; ++i)
     {
-        nc::NdArray<double> p_diag;
-        for (int i = 0; i < 3; ++i)
+        if (steady.converged && filter.steps() == steady_step)
         {
-            p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-        }
-
-        const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-        const nc::NdArray<double> Q = Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-        const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
-        const double R = V * V;
-        nc::NdArray<double> p = 0.01 * p_diag * I;
-
-        for (int i = 0; i < n - 1; ++i)
-        {
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-            x_err_pmin = nc::hstack({ x_err_pmin, nc::dot(F, x_err_pmin(x_err_pmin.rSlice(), i)) + K * (z(0, i + 1) - nc::dot(nc::dot(H, F), x_err_pmin(x_err_pmin.rSlice(), i))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
+            filter.setGain(steady.K);
         }
+        filter.step(z.column(i + 1));
+        x_err_steady.setColumn(i + 1, filter.state());
     }
 
+    // Deviation from the full covariance recursion, relative to the estimate range
+    std::cout << "Steady-state gain from step " << steady_step << ", max deviation from full recursion:";
+    for (nc::uint32 k = 0; k < 3; ++k)
     {
-        nc::NdArray<double> p_diag;
-        for (int i = 0; i < 3; ++i)
+        double deviation = 0.;
+        double range = 0.;
+        for (nc::uint32 i = 0; i < n; ++i)
         {
-            p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-        }
-
-        const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-        const nc::NdArray<double> Q = Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-        const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
-        const double R = V * V;
-        nc::NdArray<double> p = 100. * p_diag * I;
-
-        for (int i = 0; i < n - 1; ++i)
-        {
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-            x_err_pmax = nc::hstack({ x_err_pmax, nc::dot(F, x_err_pmax(x_err_pmax.rSlice(), i)) + K * (z(0, i + 1) - nc::dot(nc::dot(H, F), x_err_pmax(x_err_pmax.rSlice(), i))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
+            deviation = std::max(deviation, std::abs(x_err_steady(k, i) - x_err(k, i)));
+            range = std::max(range, std::abs(x_err(k, i)));
         }
+        std::cout << " " << (range > 0. ? deviation / range : deviation);
     }
+    std::cout << std::endl;
 }
 
-// 2.3. Kalman Filter with various R
-void Solution::setupKalmanFilterR()
+// 2.2. Rauch-Tung-Striebel smoothing of the default filter
+void Solution::setupKalmanSmoother()
 {
-    {
-        nc::NdArray<double> p_diag;
-        for (int i = 0; i < 3; ++i)
-        {
-            p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-        }
+    const double V = measurementNoise();
+    const RtsSmoother<3, 1> smoother(makeModel(Q_optimal[0], V * V), kalman::Vector<3>(), initialCovariance());
 
-        const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-        const nc::NdArray<double> Q = Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-        const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
-        const double R = 0.01 * V * V;
-        nc::NdArray<double> p = p_diag * I;
-
-        for (int i = 0; i < n - 1; ++i)
-        {
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-            x_err_rmin = nc::hstack({ x_err_rmin, nc::dot(F, x_err_rmin(x_err_rmin.rSlice(), i)) + K * (z(0, i + 1) - nc::dot(nc::dot(H, F), x_err_rmin(x_err_rmin.rSlice(), i))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
-        }
+    x_err_smooth = Trajectory<3>(n);
+    const auto measurement = [this](std::size_t k) { return z.column(k); };
+    const auto sink = [this](std::size_t k, const kalman::Vector<3> &xs) { x_err_smooth.setColumn(k, xs); };
+    if (settings.smoother_checkpoints)
+    {
+        smoother.smoothCheckpointed(n, measurement, sink);
     }
-
+    else if (!settings.smoother_buffer.empty())
     {
-        nc::NdArray<double> p_diag;
-        for (int i = 0; i < 3; ++i)
-        {
-            p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-        }
-
-        const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-        const nc::NdArray<double> Q = Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-        const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
-        const double R = 100. * V * V;
-        nc::NdArray<double> p = p_diag * I;
-
-        for (int i = 0; i < n - 1; ++i)
-        {
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-            x_err_rmax = nc::hstack({ x_err_rmax, nc::dot(F, x_err_rmax(x_err_rmax.rSlice(), i)) + K * (z(0, i + 1) - nc::dot(nc::dot(H, F), x_err_rmax(x_err_rmax.rSlice(), i))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
-        }
+        // One file per seed, so concurrent runs can share the directory
+        smoother.smooth(n, measurement, sink, settings.smoother_buffer + "/smoother_" + std::to_string(seed) + ".bin");
     }
-}
-
-// 2.3. Kalman Filter with various Q
-void Solution::setupKalmanFilterQ()
-{
+    else
     {
-        nc::NdArray<double> p_diag;
-        for (int i = 0; i < 3; ++i)
-        {
-            p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-        }
-
-        const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-        const nc::NdArray<double> Q = 0.01 * Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-        const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
-        const double R = V * V;
-        nc::NdArray<double> p = p_diag * I;
-
-        for (int i = 0; i < n - 1; ++i)
-        {
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-            x_err_qmin = nc::hstack({ x_err_qmin, nc::dot(F, x_err_qmin(x_err_qmin.rSlice(), i)) + K * (z(0, i + 1) - nc::dot(nc::dot(H, F), x_err_qmin(x_err_qmin.rSlice(), i))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
-        }
+        smoother.smooth(n, measurement, sink);
     }
 
+    // Drift RMS error, the quantity gyros are calibrated against
+    double filtered = 0.;
+    double smoothed = 0.;
+    for (nc::uint32 i = 0; i < n; ++i)
     {
-        nc::NdArray<double> p_diag;
-        for (int i = 0; i < 3; ++i)
-        {
-            p_diag = nc::append(p_diag, nc::dot( nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice())) ));
-        }
-
-        const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-        const nc::NdArray<double> Q = 100. * Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-        const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
-        const double R = V * V;
-        nc::NdArray<double> p = p_diag * I;
-
-        for (int i = 0; i < n - 1; ++i)
-        {
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(P, nc::transpose(H)) * nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R);
-            x_err_qmax = nc::hstack({ x_err_qmax, nc::dot(F, x_err_qmax(x_err_qmax.rSlice(), i)) + K * (z(0, i + 1) - nc::dot(nc::dot(H, F), x_err_qmax(x_err_qmax.rSlice(), i))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
-        }
+        filtered += (x(2, i) - x_err(2, i)) * (x(2, i) - x_err(2, i)) / n;
+        smoothed += (x(2, i) - x_err_smooth(2, i)) * (x(2, i) - x_err_smooth(2, i)) / n;
     }
+    std::cout << "Drift RMS error: filtered = " << std::sqrt(filtered) << ", smoothed = " << std::sqrt(smoothed) << std::endl;
 }
 
 // 2.4. Kalman Filter with long-term estimation (from 90th minute)
 void Solution::setupKalmanFilterLong()
 {
-    nc::NdArray<double> t_long = nc::linspace(1., 90. * 60., 90. * 60. + 1.);
+    const nc::uint32 t_long = 90 * 60 + 1;
+    const kalman::Matrix<3, 3> F_k = makeModel(0., 0.).F;
 
-    for (int i = 0; i < n - 1; ++i)
+    x_err_long = Trajectory<3>(n);
+    for (nc::uint32 i = 0; i < n - 1; ++i)
     {
-        if (i < t_long.shape().cols)
+        kalman::Vector<3> x_next;
+        if (i < t_long)
         {
-            x_err_long = nc::hstack({ x_err_long, x_err(x_err.rSlice(), i) });
+            x_next = x_err.column(i);
         }
         else
         {
-
-            x_err_long = nc::hstack({ x_err_long, nc::dot(F, x_err_long(x_err_long.rSlice(), i)) });
+            x_next = F_k * x_err_long.column(i);
         }
+
+        x_err_long.setColumn(i + 1, x_next);
     }
 }
 
 // 2.5. Kalman Filter with short-term estimation
 void Solution::setupKalmanFilterShort()
 {
-    nc::NdArray<double> p_diag;
-    for (int i = 0; i < 3; ++i)
-    {
-        p_diag = nc::append(p_diag, nc::dot(nc::max(x(i, x.cSlice())), nc::max(x(i, x.cSlice()))) );
-    }
-    const nc::NdArray<double> I = nc::eye<double>(nc::Shape{ 3, 3 });
-    nc::NdArray<double> p = p_diag * I;
-    const nc::NdArray<double> Q = Q_optimal[0] * nc::NdArray<double>({ {0, 0, 0}, {0, 0, 0}, {0, 0, 1} });
-    const double V = 0.1 * nc::max(x(0, x.cSlice()))[0]; // Noise intensity
-    const double R = V * V;
-
-    // Time intervals
-    nc::NdArray<int> t_5s = nc::NdArray<int>({ {5000, 5001, 5002, 5003, 5004},
-                                                     {6000, 6001, 6002, 6003, 6004},
-                                                     {7000, 7001, 7002, 7003, 7004} });
-    nc::NdArray<int> t_5s_last = t_5s(t_5s.rSlice(), t_5s.shape().cols - 1) + 1;
+    const kalman::Matrix<3, 3> p0 = initialCovariance();
+    KalmanFilter<3, 1> filter = makeFilter();
 
-    nc::NdArray<int> t_5m = nc::linspace(1000, 1299, 300);
-    t_5m = nc::vstack( { t_5m, nc::linspace(3000, 3299, 300) } );
-    nc::NdArray<int> t_5m_last = t_5m(t_5m.rSlice(), t_5m.shape().cols - 1) + 1;
+    // Measurement outages: 5 s and 5 min time intervals
+    struct Outage
+    {
+        nc::uint32 begin;
+        nc::uint32 length;
+    };
+    constexpr std::array<Outage, 5> outages = { { {5000, 5}, {6000, 5}, {7000, 5}, {1000, 300}, {3000, 300} } };
 
-    for (int i = 0; i < n - 1; ++i)
+    x_err_short = Trajectory<3>(n);
+    for (nc::uint32 i = 0; i < n - 1; ++i)
     {
-        if (nc::any(t_5s_last == i)[0] || nc::any(t_5m_last == i)[0])
+        bool outage = false;
+        for (const Outage &o : outages)
         {
-            p = p_diag * I;
+            // Covariance is reset on the first step after the outage
+            if (i == o.begin + o.length)
+            {
+                filter.resetCovariance(p0);
+            }
+            outage = outage || (i >= o.begin && i < o.begin + o.length);
         }
 
-        if (nc::any(t_5s == i)[0] || nc::any(t_5m == i)[0])
+        // No measurement during an outage: prediction only
+        filter.predict();
+        if (!outage)
         {
-            x_err_short = nc::hstack({ x_err_short, nc::dot(F, x_err_short(x_err_short.rSlice(), i)) });
+            filter.update(z.column(i + 1));
         }
-        else
+
+        x_err_short.setColumn(i + 1, filter.state());
+    }
+}
+
+// Measurement noise intensity
+double Solution::measurementNoise() const
+{
+    return constants::measurement_noise * x.max(0);
+}
+
+// Initial covariance: squared maximum of each state component on the diagonal
+kalman::Matrix<3, 3> Solution::initialCovariance() const
+{
+    std::array<double, 3> p_diag;
+    for (nc::uint32 i = 0; i < 3; ++i)
+    {
+        const double x_max = x.max(i);
+        p_diag[i] = x_max * x_max;
+    }
+    return kalman::Matrix<3, 3>::diagonal(p_diag);
+}
+
+KalmanFilter<3, 1> Solution::makeFilter() const
+{
+    const double V = measurementNoise();
+    return KalmanFilter<3, 1>(makeModel(Q_optimal[0], V * V), kalman::Vector<3>(), initialCovariance());
+}
+
+Solution::Model Solution::makeModel(double q, double r) const
+{
+    Model model;
+    for (nc::uint32 i = 0; i < 3; ++i)
+    {
+        for (nc::uint32 j = 0; j < 3; ++j)
         {
-            const nc::NdArray<double> x_err_prev = nc::dot(F, x_err_short(x_err_short.rSlice(), i));
-            const nc::NdArray<double> P = nc::dot(nc::dot(F, p), nc::transpose(F)) + Q;
-            const nc::NdArray<double> K = nc::dot(nc::dot(P, nc::transpose(H)), nc::linalg::inv(nc::dot(nc::dot(H, P), nc::transpose(H)) + R));
-            x_err_short = nc::hstack({ x_err_short, x_err_prev + nc::dot(K, (z(0, i + 1) - nc::dot(H, x_err_prev))) });
-            p = nc::dot((I - nc::dot(K, H)), P);
+            model.F(i, j) = F(i, j);
         }
+        model.H(0, i) = H[i];
     }
+    model.Q(2, 2) = q;
+    model.R(0, 0) = r;
+    return model;
 }
@@ -2,6 +2,12 @@
 #define SOLUTION_H
 
 #include "NumCpp.hpp"
+#include "kalman.h"
+#include "kalmanfilter.h"
+#include "trajectory.h"
+
+#include <functional>
+#include <string>
 
 namespace constants
 {
@@ -18,12 +24,64 @@ namespace constants
     // White noise parameters
     constexpr double mu = 0.;
     constexpr double sigma = 1.;
+
+    // Drift noise gain and measurement noise relative to the peak speed error
+    constexpr double drift_noise = 5e-08;
+    constexpr double measurement_noise = 0.1;
+
+    // Relative covariance change below which the filter gain is held constant
+    constexpr double steady_state_tolerance = 1e-9;
 }
 
+// Run options the drivers expose; the defaults reproduce the report
+struct SolutionSettings
+{
+    // Q sweep over the log grid 10^q_power_min .. 10^q_power_max, then
+    // q_refine_levels - 1 finer grids around the best q (QSweep::refine)
+    double q_power_min = -20.;
+    double q_power_max = -1.;
+    std::size_t q_points = 20;
+    std::size_t q_refine_levels = 1;
+
+    // RTS smoother forward records: in memory by default, in a temporary
+    // file in smoother_buffer when set, or recomputed block by block from
+    // about sqrt(n) checkpoints when smoother_checkpoints is on
+    std::string smoother_buffer;
+    bool smoother_checkpoints = false;
+};
+
 class Solution
 {
 public:
-    Solution();
+    // Computation stages in the order run() goes through them
+    enum class Stage
+    {
+        Simulation,
+        QSweep,
+        Filters,
+        SteadyState,
+        Smoother,
+        Long,
+        Short,
+    };
+    static constexpr int stages = 7;
+
+    // Called after each stage; returning false stops the run there
+    using StageCallback = std::function<bool(Stage)>;
+
+    // Tag for a Solution whose histories stay empty until run() is called
+    struct Deferred {};
+
+    // Noise comes from the counter-based stream (seed, run 0)
+    explicit Solution(std::uint64_t seed = 0, const SolutionSettings &settings = {});
+    explicit Solution(Deferred, std::uint64_t seed = 0, const SolutionSettings &settings = {});
+
+    // Runs every stage. Each stage only writes its own members, so they can be
+    // read by another thread once the callback has reported that stage.
+    void run(const StageCallback &finished = {});
+
+    const std::uint64_t seed;
+    const SolutionSettings settings;
 
     const nc::NdArray<double> A = { {0, -constants::g, 0}, {1 / constants::R, 0, 1}, {0, 0, 0} };
 
@@ -31,30 +89,44 @@ public:
     const nc::NdArray<double> F = static_cast<double>(constants::T) * A + nc::eye<double>(nc::Shape{ 3, 3 });
     const nc::NdArray<double> H = { 1, 0, 0 }; // Observation matrix
 
-    // State vector
-    nc::NdArray<double> x = nc::transpose(nc::NdArray<double>({ 0, 0, constants::betta * nc::constants::pi / 180 / 3600 }));
-    nc::NdArray<double> z;
+    // Initial state vector
+    const kalman::Vector<3> x0 = { {0}, {0}, {constants::betta * nc::constants::pi / 180 / 3600} };
 
     nc::NdArray<double> t = nc::linspace(0., constants::simulation_time, constants::simulation_time + 1);
     const nc::uint32 n = std::size(t);
 
+    // State and measurement histories
+    Trajectory<3> x;
+    Trajectory<1> z;
+
     std::array<double, 4> Q_optimal;
 
-    nc::NdArray<double> x_err = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
+    Trajectory<3> x_err;
+
+    Trajectory<3> x_err_pmin;
+    Trajectory<3> x_err_pmax;
+
+    Trajectory<3> x_err_rmin;
+    Trajectory<3> x_err_rmax;
 
-    nc::NdArray<double> x_err_pmin = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
-    nc::NdArray<double> x_err_pmax = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
+    Trajectory<3> x_err_qmin;
+    Trajectory<3> x_err_qmax;
 
-    nc::NdArray<double> x_err_rmin = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
-    nc::NdArray<double> x_err_rmax = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
+    // Default filter switched to the steady-state gain once p settles
+    Trajectory<3> x_err_steady;
 
-    nc::NdArray<double> x_err_qmin = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
-    nc::NdArray<double> x_err_qmax = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
+    // Default filter smoothed backwards over the whole run
+    Trajectory<3> x_err_smooth;
 
-    nc::NdArray<double> x_err_long = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
-    nc::NdArray<double> x_err_short = nc::transpose(nc::NdArray<double>({ 0, 0, 0 }));
+    Trajectory<3> x_err_long;
+    Trajectory<3> x_err_short;
+
+    // Online filter with the default tuning, starting from the zero estimate
+    KalmanFilter<3, 1> makeFilter() const;
 
 private:
+    using Model = kalman::Model<3, 1>;
+
     nc::NdArray<double> w;
     void generateWhiteNoise(nc::uint32 n, double mu = 0., double sigma = 1.);
 
@@ -64,11 +136,15 @@ private:
     void estimateOptimalQ();
 
     void setupKalmanFilter();
-    void setupKalmanFilterP();
-    void setupKalmanFilterR();
-    void setupKalmanFilterQ();
+    void setupKalmanFilterSteadyState();
+    void setupKalmanSmoother();
     void setupKalmanFilterLong();
     void setupKalmanFilterShort();
+
+    // Filter building blocks shared by the setupKalmanFilter*() runs
+    double measurementNoise() const;
+    kalman::Matrix<3, 3> initialCovariance() const;
+    Model makeModel(double q, double r) const;
 };
 
 #endif // SOLUTION_H
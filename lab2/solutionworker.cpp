@@ -0,0 +1,22 @@
+#include "solutionworker.h"
+
+#include <QThread>
+
+#include <chrono>
+
+SolutionWorker::SolutionWorker(Solution &solution)
+    : solution(solution)
+{
+}
+
+void SolutionWorker::run()
+{
+    const auto start = std::chrono::steady_clock::now();
+    solution.run([this](Solution::Stage stage)
+    {
+        emit stageFinished(static_cast<int>(stage));
+        return !QThread::currentThread()->isInterruptionRequested();
+    });
+    const auto stop = std::chrono::steady_clock::now();
+    emit finished(std::chrono::duration<double, std::milli>(stop - start).count());
+}
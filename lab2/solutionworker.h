@@ -0,0 +1,29 @@
+#ifndef SOLUTIONWORKER_H
+#define SOLUTIONWORKER_H
+
+#include <QObject>
+#include "solution.h"
+
+// Runs Solution::run() on the thread it has been moved to and reports every
+// finished stage. Receivers in the GUI thread get the signals queued, after
+// the stage's members have been written.
+class SolutionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SolutionWorker(Solution &solution);
+
+public slots:
+    void run();
+
+signals:
+    // Solution::Stage as int, so the queued connection needs no metatype
+    void stageFinished(int stage);
+    void finished(double ms);
+
+private:
+    Solution &solution;
+};
+
+#endif // SOLUTIONWORKER_H
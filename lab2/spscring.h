@@ -0,0 +1,56 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Head and tail live on separate cache lines so the two sides do not share
+// a line they both write.
+template <typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false when the ring is full.
+    bool push(const T &value)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        buffer[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Hands every queued element to sink, returns how many.
+    template <typename Sink>
+    std::size_t drain(Sink &&sink)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        for (std::size_t i = head; i != tail; ++i)
+        {
+            sink(buffer[i & (Capacity - 1)]);
+        }
+        head_.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    // Consumer side, discards everything queued
+    void clear()
+    {
+        head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    std::array<T, Capacity> buffer;
+    alignas(64) std::atomic<std::size_t> head_ { 0 };
+    alignas(64) std::atomic<std::size_t> tail_ { 0 };
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,726 @@
+#ifndef STRAPDOWN_H
+#define STRAPDOWN_H
+
+#include "coning.h"
+#include "kalman.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+// Strapdown navigation algorithm of hw/main.Rmd: the fast body-frame
+// quaternion, the slow navigation-frame quaternion, the Poisson update of the
+// Earth-to-navigation matrix and the WGS-84 radii. Steps are numbered as in
+// the reference cycle and the arithmetic follows it closely. With the
+// Reference Coriolis sum, INS_Navigation --r-compatible --compare checks
+// every 100th step against reference/navigation_10hz_port.csv, written by a
+// Python transliteration of the R loop, or against the
+// navigation_10hz_r.csv that knitting hw/main.Rmd writes. All state is
+// fixed-size, a step does not allocate.
+//
+// The attitude quaternion is updated at the sensor rate (h_N1). The
+// navigation update runs every divisor-th sample (h_N3) on the velocity
+// increments accumulated in between. With coning and sculling compensation
+// of ConingSamples samples the attitude is updated once per window of that
+// many samples instead, from the compensated rotation vector.
+//
+// Earth model, quaternion normalization, the Coriolis sum and sensor errors
+// are policy types, so every configuration compiles to its own loop without
+// flag tests; simulate(scenario, pipeline, ...) picks the instantiation at
+// run time.
+namespace strapdown
+{
+    using Vector3 = kalman::Vector<3>;
+    using Dcm = kalman::Matrix<3, 3>;
+
+    namespace wgs84
+    {
+        constexpr double g = 9.815;
+        constexpr double a = 6378137;
+        constexpr double b = 6356752.3;
+
+        // Named e in the reference but holds (a^2 - b^2) / a^2; the radii
+        // square it once more, kept that way to reproduce the R results
+        constexpr double e = (a * a - b * b) / (a * a);
+
+        constexpr double U = 2 * 3.14159265358979323846 / (24 * 60 * 60);
+    }
+
+    // The element type defaults to double; a SIMD pack holds one quaternion
+    // per lane for the batched engine
+    template <typename T = double>
+    struct Quaternion
+    {
+        T q0 = T(1.);
+        T q1 = T(0.);
+        T q2 = T(0.);
+        T q3 = T(0.);
+
+        T squaredNorm() const { return q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3; }
+    };
+
+    // quatmultiply
+    template <typename T>
+    Quaternion<T> operator*(const Quaternion<T> &q, const Quaternion<T> &r)
+    {
+        return {
+            q.q0 * r.q0 - q.q1 * r.q1 - q.q2 * r.q2 - q.q3 * r.q3,
+            q.q0 * r.q1 + r.q0 * q.q1 + q.q2 * r.q3 - q.q3 * r.q2,
+            q.q0 * r.q2 + r.q0 * q.q2 + q.q3 * r.q1 - q.q1 * r.q3,
+            q.q0 * r.q3 + r.q0 * q.q3 + q.q1 * r.q2 - q.q2 * r.q1,
+        };
+    }
+
+    // new_C: body to navigation frame cosine matrix
+    template <typename T>
+    kalman::Matrix<3, 3, T> toDcm(const Quaternion<T> &q)
+    {
+        kalman::Matrix<3, 3, T> c;
+        c(0, 0) = q.q0 * q.q0 + q.q1 * q.q1 - q.q2 * q.q2 - q.q3 * q.q3;
+        c(0, 1) = T(2.) * (q.q1 * q.q2 - q.q0 * q.q3);
+        c(0, 2) = T(2.) * (q.q1 * q.q3 + q.q0 * q.q2);
+        c(1, 0) = T(2.) * (q.q1 * q.q2 + q.q0 * q.q3);
+        c(1, 1) = q.q0 * q.q0 + q.q2 * q.q2 - q.q1 * q.q1 - q.q3 * q.q3;
+        c(1, 2) = T(2.) * (q.q2 * q.q3 - q.q0 * q.q1);
+        c(2, 0) = T(2.) * (q.q1 * q.q3 - q.q0 * q.q2);
+        c(2, 1) = T(2.) * (q.q2 * q.q3 + q.q0 * q.q1);
+        c(2, 2) = q.q0 * q.q0 + q.q3 * q.q3 - q.q1 * q.q1 - q.q2 * q.q2;
+        return c;
+    }
+
+    // B_E2N for the initial latitude, longitude and azimuth
+    inline Dcm initialEarthToNavigation(double phi, double lambda, double eps)
+    {
+        Dcm b;
+        b(0, 0) = -std::sin(phi) * std::cos(lambda) * std::sin(eps) - std::sin(lambda) * std::cos(eps);
+        b(0, 1) = std::sin(phi) * std::sin(lambda) * std::sin(eps) + std::cos(lambda) * std::cos(eps);
+        b(0, 2) = std::cos(phi) * std::sin(eps);
+        b(1, 0) = -std::sin(phi) * std::cos(lambda) * std::cos(eps) + std::sin(lambda) * std::sin(eps);
+        b(1, 1) = -std::sin(phi) * std::sin(lambda) * std::cos(eps) - std::cos(lambda) * std::sin(eps);
+        b(1, 2) = std::cos(phi) * std::cos(eps);
+        b(2, 0) = std::cos(phi) * std::cos(lambda);
+        b(2, 1) = std::cos(phi) * std::sin(lambda);
+        b(2, 2) = std::sin(phi);
+        return b;
+    }
+
+    // new_B: recursive Poisson update. As in the reference only the entries
+    // the cycle reads are propagated, the others are left at zero.
+    template <typename T>
+    kalman::Matrix<3, 3, T> poisson(const kalman::Matrix<3, 3, T> &b, const kalman::Vector<3, T> &omega, const T &h)
+    {
+        kalman::Matrix<3, 3, T> next;
+        next(0, 1) = b(0, 1) - omega[1] * b(2, 1) * h;
+        next(1, 1) = b(1, 1) + omega[0] * b(2, 1) * h;
+        next(2, 1) = b(2, 1) + (omega[1] * b(0, 1) - omega[0] * b(1, 1)) * h;
+        next(0, 2) = b(0, 2) - omega[1] * b(2, 2) * h;
+        next(1, 2) = b(1, 2) + omega[0] * b(2, 2) * h;
+        next(2, 2) = b(2, 2) + (omega[1] * b(0, 2) - omega[0] * b(1, 2)) * h;
+        next(2, 0) = next(0, 1) * next(1, 2) - next(1, 1) * next(0, 2);
+        return next;
+    }
+
+    // Gyro and accelerometer increments of one sensor interval, body frame
+    struct Increments
+    {
+        Vector3 angle;
+        Vector3 velocity;
+    };
+
+    // Outputs of one cycle, in rad and m/s, named as in the reference
+    struct Navigation
+    {
+        double theta = 0.;
+        double gamma = 0.;
+        double psi = 0.;
+        double heading = 0.;
+        double v_n = 0.;
+        double v_e = 0.;
+        double phi = 0.;
+        double lambda = 0.;
+        double eps = 0.;
+    };
+
+    // Steps 11 and 13 to 15: angles, coordinates, heading and Earth-frame
+    // speed from the attitude matrix, B_E2N and the navigation velocity
+    inline Navigation outputs(const Dcm &c, const Dcm &b, const Vector3 &v)
+    {
+        Navigation nav;
+        nav.theta = std::atan2(c(2, 1), std::sqrt(c(2, 0) * c(2, 0) + c(2, 2) * c(2, 2)));
+        nav.gamma = -std::atan2(c(2, 0), c(2, 2));
+        nav.psi = -std::atan2(c(0, 1), c(1, 1));
+        nav.phi = std::atan2(b(2, 2), std::sqrt(b(2, 0) * b(2, 0) + b(1, 2) * b(1, 2)));
+        nav.lambda = std::atan2(b(2, 1), b(2, 0));
+        nav.eps = std::atan2(b(0, 2), b(1, 2));
+        nav.heading = -(nav.psi - nav.eps);
+        nav.v_n = v[1] * std::cos(nav.eps) + v[0] * std::sin(nav.eps);
+        nav.v_e = -v[1] * std::sin(nav.eps) + v[0] * std::cos(nav.eps);
+        return nav;
+    }
+
+    struct Config
+    {
+        double phi_0 = 27. * 3.14159265358979323846 / 180.;
+        double lambda_0 = 13. * 3.14159265358979323846 / 180.;
+        double eps_0 = 0.;
+        double height = 0.;
+
+        // Sensor interval h_N1, s
+        double h_fast = 0.1;
+
+        // Sensor intervals per navigation update: h_N3 = divisor * h_N1.
+        // The reference runs both loops at the same rate (divisor 1).
+        std::size_t divisor = 1;
+
+        double h_slow() const { return h_fast * static_cast<double>(divisor); }
+    };
+
+    // Scalar counterpart of simd::above: value where it exceeds threshold, 0
+    // elsewhere
+    inline double above(double value, double threshold)
+    {
+        return value > threshold ? value : 0.;
+    }
+
+    // The policies below are templated on the element type like the
+    // quaternion helpers, so the batched engine runs them on SIMD packs
+
+    // Step 7: frame rate omega of the navigation frame from B_E2N, the
+    // navigation velocity and the height
+    namespace earth
+    {
+        // Radii of curvature of the reference
+        struct Wgs84
+        {
+            template <typename T>
+            static kalman::Vector<3, T> frameRate(const kalman::Matrix<3, 3, T> &b, const kalman::Vector<3, T> &v, const T &height)
+            {
+                const T e2(wgs84::e * wgs84::e);
+                const T a(wgs84::a);
+                const T base = T(1.) - e2 * b(2, 2) * b(2, 2) * T(0.5) - height / a;
+                const T r_x = a / (base + e2 * b(0, 2) * b(0, 2));
+                const T r_y = a / (base + e2 * b(1, 2) * b(1, 2));
+                const T cross = e2 * b(0, 2) * b(1, 2) / a;
+                return { { -v[1] / r_y - v[0] * cross }, { v[0] / r_x + v[1] * cross }, { T(0.) } };
+            }
+        };
+
+        // One radius, that of the error model (constants::R)
+        struct Sphere
+        {
+            static constexpr double radius = 6'371'300;
+
+            template <typename T>
+            static kalman::Vector<3, T> frameRate(const kalman::Matrix<3, 3, T> &, const kalman::Vector<3, T> &v, const T &height)
+            {
+                const T r = T(radius) + height;
+                return { { -v[1] / r }, { v[0] / r }, { T(0.) } };
+            }
+        };
+    }
+
+    // Step 9: keeps the attitude quaternion at unit norm
+    namespace normalization
+    {
+        // First order in the defect, skipped below 1e-15 as in the reference.
+        // A skipped lane scales by exactly 1, so there is no branch.
+        struct FirstOrder
+        {
+            template <typename T>
+            static Quaternion<T> apply(const Quaternion<T> &q)
+            {
+                using std::sqrt;
+                const T defect = above(T(1.) - sqrt(q.squaredNorm()), T(1e-15));
+                const T scale = T(1.) + defect * T(0.5);
+                return { q.q0 * scale, q.q1 * scale, q.q2 * scale, q.q3 * scale };
+            }
+        };
+
+        // Division by the norm
+        struct Exact
+        {
+            template <typename T>
+            static Quaternion<T> apply(const Quaternion<T> &q)
+            {
+                using std::sqrt;
+                const T scale = T(1.) / sqrt(q.squaredNorm());
+                return { q.q0 * scale, q.q1 * scale, q.q2 * scale, q.q3 * scale };
+            }
+        };
+    }
+
+    // Step 7: Coriolis terms added to the velocity at each navigation update
+    namespace coriolis
+    {
+        // Integrand summed without the interval, as the reference does. Only
+        // for reproducing the R outputs: the sum approximates the integral at
+        // the reference's own 10 Hz, divisor 1 setup at best and diverges at
+        // kHz rates.
+        struct Reference
+        {
+            template <typename T>
+            static T interval(const T &) { return T(1.); }
+        };
+
+        // Integral over h_N3, the default
+        struct Integrated
+        {
+            template <typename T>
+            static T interval(const T &h) { return h; }
+        };
+    }
+
+    template <std::size_t ConingSamples = 1, typename Earth = earth::Wgs84, typename Normalization = normalization::FirstOrder,
+        typename Coriolis = coriolis::Integrated>
+    class Engine
+    {
+    public:
+        static constexpr std::size_t coning_samples = ConingSamples;
+
+        explicit Engine(const Config &config = {})
+            : config(config)
+            , b(initialEarthToNavigation(config.phi_0, config.lambda_0, config.eps_0))
+        {
+            if (config.divisor == 0)
+            {
+                throw std::invalid_argument("Navigation divisor must be at least 1");
+            }
+            if (config.divisor % ConingSamples != 0)
+            {
+                throw std::invalid_argument("Navigation divisor must be a multiple of the coning window");
+            }
+            nav.phi = config.phi_0;
+            nav.lambda = config.lambda_0;
+            nav.eps = config.eps_0;
+        }
+
+        // Feeds one sensor interval. The attitude quaternion is updated at
+        // once; the navigation update runs on every divisor-th call and then
+        // returns true.
+        bool step(const Increments &increments)
+        {
+            fast(increments);
+            if (++accumulated < config.divisor)
+            {
+                return false;
+            }
+            slow();
+            accumulated = 0;
+            return true;
+        }
+
+        const Navigation &navigation() const { return nav; }
+        const Quaternion<> &attitude() const { return q; }
+        const Dcm &bodyToNavigation() const { return c; }
+        const Dcm &earthToNavigation() const { return b; }
+        const Vector3 &velocity() const { return v; }
+
+        // Navigation updates run so far
+        std::size_t steps() const { return count; }
+
+    private:
+        const Config config;
+
+        Quaternion<> q;
+        Dcm c = Dcm::identity();
+        Dcm b;
+        Vector3 v;
+        Vector3 omega;
+        std::array<double, 2> sum_w {};
+        std::array<double, 2> sum_k {};
+        Navigation nav;
+        std::size_t count = 0;
+
+        // Body-frame velocity increment since the last navigation update, in
+        // the body frame of that update, and the rotation since then
+        Vector3 w_b;
+        Vector3 alpha;
+        std::size_t accumulated = 0;
+
+        coning::Compensator<ConingSamples> compensator;
+
+        // Sensor rate loop: steps 3 to 5 and the accumulation of step 4
+        void fast(const Increments &increments)
+        {
+            if (!compensator.add(increments.angle, increments.velocity))
+            {
+                return;
+            }
+            const coning::Window window = compensator.take();
+
+            // 3, 5: fast motion quaternion, body to inertial frame
+            const Vector3 &dphi = window.rotation;
+            const double dphi2 = dphi[0] * dphi[0] + dphi[1] * dphi[1] + dphi[2] * dphi[2];
+            const double r = 0.5 - dphi2 / 48 - dphi2 * dphi2 / 3840;
+            const Quaternion<> delta_lambda { 1 - dphi2 / 8 + dphi2 * dphi2 / 384, r * dphi[0], r * dphi[1], r * dphi[2] };
+            q = q * delta_lambda;
+
+            // 4: velocity increments add up in the body frame. Compensated
+            // windows are first rotated back to the frame of the last update.
+            if (ConingSamples == 1)
+            {
+                w_b += window.velocity;
+                return;
+            }
+            w_b += window.velocity + coning::cross(alpha, window.velocity);
+            alpha += dphi;
+        }
+
+        // Navigation rate loop: steps 6 to 15 over h_N3
+        void slow()
+        {
+            const double h = config.h_slow();
+
+            // 6: velocity increment in the navigation frame, with the attitude
+            // of the previous update as in the reference
+            const Vector3 w = c * w_b;
+            w_b = Vector3();
+            alpha = Vector3();
+
+            // 7: velocities, Coriolis terms, radii and frame rate
+            const Vector3 u { { wgs84::U * b(0, 2) }, { wgs84::U * b(1, 2) }, { wgs84::U * b(2, 2) } };
+            sum_w[0] += w[0];
+            sum_w[1] += w[1];
+
+            sum_k[0] += (2 * v[1] * u[2] - v[2] * (omega[1] + 2 * u[1])) * Coriolis::interval(h);
+            sum_k[1] += (2 * v[0] * u[2] - v[2] * (omega[0] + 2 * u[0])) * Coriolis::interval(h);
+            v[0] = sum_w[0] + sum_k[0];
+            v[1] = sum_w[1] + sum_k[1];
+
+            omega = Earth::frameRate(b, v, config.height);
+
+            // 8: slow motion quaternion, inertial to navigation frame
+            const Vector3 rate = omega + u;
+            const double rate_norm = std::sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]);
+            const double half = rate_norm * h / 2;
+            const double s = rate_norm > 0. ? -std::sin(half) / rate_norm : 0.;
+            const Quaternion<> delta_m { std::cos(half), s * rate[0], s * rate[1], s * rate[2] };
+            q = delta_m * q;
+
+            // 9: normalization
+            q = Normalization::apply(q);
+
+            // 10, 12: attitude matrix and position matrix
+            c = toDcm(q);
+            b = poisson(b, omega, h);
+
+            // 11, 13 - 15: outputs
+            nav = outputs(c, b, v);
+            ++count;
+        }
+    };
+
+    // Sensor errors added to the rates (or increments) of the scenario
+    namespace errors
+    {
+        // Ideal sensors, inaccuracies_enabled off. T is double, or a
+        // simd::Pack of per-trajectory values in the batch engine.
+        struct None
+        {
+            template <typename T>
+            static void apply(kalman::Vector<3, T> &, kalman::Vector<3, T> &, const T &, const T &) {}
+        };
+
+        // Gyro drift and accelerometer bias on every axis
+        struct BiasDrift
+        {
+            template <typename T>
+            static void apply(kalman::Vector<3, T> &gyr, kalman::Vector<3, T> &acc, const T &bias, const T &drift)
+            {
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    gyr[i] += drift;
+                    acc[i] += bias;
+                }
+            }
+        };
+    }
+
+    // Sensor model of the reference (step 1): a platform at rest whose gyros
+    // and accelerometers see Earth rate and gravity through the computed
+    // attitude, optionally with bias and drift, plus a timed turn about one axis
+    //
+    // That closed loop holds the attitude over a navigation interval or coning
+    // window, so it cannot show what multi-rate runs and coning/sculling
+    // compensation gain. Without closed_loop the sensors see the true attitude
+    // of the turn instead and the increments are integrated over the interval.
+    struct Scenario
+    {
+        bool closed_loop = true;
+
+        double rate = 10.;
+        std::size_t divisor = 1;
+        double phi_0 = Config().phi_0;
+        double eps_0 = Config().eps_0;
+
+        bool inaccuracies = false;
+        double bias = 25 * wgs84::g * 1e-6;
+        double drift = 0.01 * 3.14159265358979323846 / 180. / 3600;
+
+        bool rotation = true;
+        std::size_t axis = 1;
+        double rotation_angle = 10. * 3.14159265358979323846 / 180.;
+        double rotation_start = 60 * 60;
+        double rotation_duration = 5;
+
+        Config config() const
+        {
+            Config result;
+            result.phi_0 = phi_0;
+            result.eps_0 = eps_0;
+            result.h_fast = 1 / rate;
+            result.divisor = divisor;
+            return result;
+        }
+
+        // Earth rate in the navigation frame at the start, U * B_E2N[, 3]
+        Vector3 earthRate() const
+        {
+            return { { wgs84::U * std::cos(phi_0) * std::sin(eps_0) }, { wgs84::U * std::cos(phi_0) * std::cos(eps_0) }, { wgs84::U * std::sin(phi_0) } };
+        }
+
+        // Increments of sensor interval step (0-based), given the attitude
+        // the engine has computed so far
+        Increments sample(std::size_t step, const Dcm &c_b2n) const
+        {
+            return inaccuracies ? sample<errors::BiasDrift>(step, c_b2n) : sample<errors::None>(step, c_b2n);
+        }
+
+        // Same with the error model fixed at compile time
+        template <typename Errors>
+        Increments sample(std::size_t step, const Dcm &c_b2n) const
+        {
+            const Vector3 gyr_n = earthRate();
+            const Vector3 acc_n { { 0. }, { 0. }, { wgs84::g } };
+            const Dcm c_n2b = kalman::transpose(c_b2n);
+            Vector3 gyr = c_n2b * gyr_n;
+            Vector3 acc = c_n2b * acc_n;
+            Errors::apply(gyr, acc, bias, drift);
+
+            // The reference counts steps from 1
+            const double i = static_cast<double>(step + 1);
+            if (rotation && i >= rate * rotation_start && i <= rate * (rotation_duration + rotation_start))
+            {
+                gyr[axis] += rotation_angle / rotation_duration;
+            }
+
+            const double h = 1 / rate;
+            return { gyr * h, acc * h };
+        }
+
+        // Turn angle at time t of the open-loop model
+        double turn(double t) const
+        {
+            return rotation ? rotation_angle * std::min(1., std::max(0., (t - rotation_start) / rotation_duration)) : 0.;
+        }
+
+        // Body to navigation matrix of the open-loop model (Rodrigues formula)
+        Dcm trueAttitude(double t) const
+        {
+            const double angle = turn(t);
+            Dcm k;
+            k((axis + 2) % 3, (axis + 1) % 3) = 1.;
+            k((axis + 1) % 3, (axis + 2) % 3) = -1.;
+            return Dcm::identity() + std::sin(angle) * k + (1 - std::cos(angle)) * (k * k);
+        }
+
+        // Open-loop increments of sensor interval step: Earth rate and gravity
+        // through the true attitude by Simpson's rule, the turn exactly
+        Increments sample(std::size_t step) const
+        {
+            return inaccuracies ? sample<errors::BiasDrift>(step) : sample<errors::None>(step);
+        }
+
+        template <typename Errors>
+        Increments sample(std::size_t step) const
+        {
+            const Vector3 gyr_n = earthRate();
+            const Vector3 acc_n { { 0. }, { 0. }, { wgs84::g } };
+            const double h = 1 / rate;
+            const double t0 = static_cast<double>(step) * h;
+
+            Increments result;
+            const double weights[] = { h / 6, 4 * h / 6, h / 6 };
+            for (int i = 0; i < 3; ++i)
+            {
+                const Dcm c_n2b = kalman::transpose(trueAttitude(t0 + i * h / 2));
+                result.angle += weights[i] * (c_n2b * gyr_n);
+                result.velocity += weights[i] * (c_n2b * acc_n);
+            }
+            result.angle[axis] += turn(t0 + h) - turn(t0);
+            Errors::apply(result.angle, result.velocity, bias * h, drift * h);
+            return result;
+        }
+    };
+
+    // Runs the scenario for the given number of sensor intervals and hands
+    // the outputs of every navigation update to sink(step, navigation), step
+    // counting sensor intervals. Sensor errors follow the Errors policy, not
+    // scenario.inaccuracies.
+    template <std::size_t ConingSamples = 1, typename Earth = earth::Wgs84, typename Normalization = normalization::FirstOrder,
+        typename Coriolis = coriolis::Integrated, typename Errors = errors::None, typename Sink>
+    void simulate(const Scenario &scenario, std::size_t steps, Sink sink)
+    {
+        Engine<ConingSamples, Earth, Normalization, Coriolis> engine(scenario.config());
+        const auto run = [&](auto sample)
+        {
+            for (std::size_t k = 0; k < steps; ++k)
+            {
+                if (engine.step(sample(k)))
+                {
+                    sink(k + 1, engine.navigation());
+                }
+            }
+        };
+
+        // The sensor model is chosen once, not per step
+        if (scenario.closed_loop)
+        {
+            run([&](std::size_t k) { return scenario.sample<Errors>(k, engine.bodyToNavigation()); });
+        }
+        else
+        {
+            run([&](std::size_t k) { return scenario.sample<Errors>(k); });
+        }
+    }
+
+    enum class EarthModel
+    {
+        Wgs84,
+        Sphere,
+    };
+
+    enum class Normalizer
+    {
+        FirstOrder,
+        Exact,
+    };
+
+    // Chosen explicitly, never from the rates: Reference only reproduces R
+    enum class CoriolisTerm
+    {
+        Integrated,
+        Reference,
+    };
+
+    // Run-time choice among the compiled engines; the sensor error model
+    // follows scenario.inaccuracies
+    struct Pipeline
+    {
+        std::size_t coning = 1;
+        EarthModel earth = EarthModel::Wgs84;
+        Normalizer normalization = Normalizer::FirstOrder;
+        CoriolisTerm coriolis = CoriolisTerm::Integrated;
+    };
+
+    // Compile-time configuration handed to the visitor of visit()
+    template <std::size_t ConingSamples, typename Earth, typename Normalization, typename Coriolis, typename Errors>
+    struct Policies
+    {
+        static constexpr std::size_t coning_samples = ConingSamples;
+        using earth_model = Earth;
+        using normalization_method = Normalization;
+        using coriolis_sum = Coriolis;
+        using sensor_errors = Errors;
+    };
+
+    // Each level turns one run-time choice into a template argument
+    namespace dispatch
+    {
+        template <std::size_t ConingSamples, typename Earth, typename Normalization, typename Coriolis, typename Visitor>
+        void withErrors(const Scenario &scenario, Visitor &visitor)
+        {
+            if (scenario.inaccuracies)
+            {
+                visitor(Policies<ConingSamples, Earth, Normalization, Coriolis, errors::BiasDrift>());
+            }
+            else
+            {
+                visitor(Policies<ConingSamples, Earth, Normalization, Coriolis, errors::None>());
+            }
+        }
+
+        template <std::size_t ConingSamples, typename Earth, typename Normalization, typename Visitor>
+        void withCoriolis(const Scenario &scenario, const Pipeline &pipeline, Visitor &visitor)
+        {
+            switch (pipeline.coriolis)
+            {
+            case CoriolisTerm::Reference:
+                withErrors<ConingSamples, Earth, Normalization, coriolis::Reference>(scenario, visitor);
+                break;
+            default:
+                withErrors<ConingSamples, Earth, Normalization, coriolis::Integrated>(scenario, visitor);
+                break;
+            }
+        }
+
+        template <std::size_t ConingSamples, typename Earth, typename Visitor>
+        void withNormalization(const Scenario &scenario, const Pipeline &pipeline, Visitor &visitor)
+        {
+            switch (pipeline.normalization)
+            {
+            case Normalizer::Exact:
+                withCoriolis<ConingSamples, Earth, normalization::Exact>(scenario, pipeline, visitor);
+                break;
+            default:
+                withCoriolis<ConingSamples, Earth, normalization::FirstOrder>(scenario, pipeline, visitor);
+                break;
+            }
+        }
+
+        template <std::size_t ConingSamples, typename Visitor>
+        void withEarth(const Scenario &scenario, const Pipeline &pipeline, Visitor &visitor)
+        {
+            switch (pipeline.earth)
+            {
+            case EarthModel::Sphere:
+                withNormalization<ConingSamples, earth::Sphere>(scenario, pipeline, visitor);
+                break;
+            default:
+                withNormalization<ConingSamples, earth::Wgs84>(scenario, pipeline, visitor);
+                break;
+            }
+        }
+    }
+
+    // Calls visitor(Policies<...>()) with the compiled configuration the
+    // pipeline and scenario.inaccuracies select; throws std::invalid_argument
+    // for a coning window other than 1 to 4 samples. The visitor body is
+    // instantiated for all 4 x 2 x 2 x 2 x 2 = 64 configurations.
+    template <typename Visitor>
+    void visit(const Scenario &scenario, const Pipeline &pipeline, Visitor visitor)
+    {
+        switch (pipeline.coning)
+        {
+        case 1:
+            dispatch::withEarth<1>(scenario, pipeline, visitor);
+            break;
+        case 2:
+            dispatch::withEarth<2>(scenario, pipeline, visitor);
+            break;
+        case 3:
+            dispatch::withEarth<3>(scenario, pipeline, visitor);
+            break;
+        case 4:
+            dispatch::withEarth<4>(scenario, pipeline, visitor);
+            break;
+        default:
+            throw std::invalid_argument("Coning algorithms are defined for 1 to 4 samples");
+        }
+    }
+
+    // Same run as simulate<...>() with the engine picked from the pipeline
+    template <typename Sink>
+    void simulate(const Scenario &scenario, const Pipeline &pipeline, std::size_t steps, Sink sink)
+    {
+        visit(scenario, pipeline, [&](auto policies)
+        {
+            using Selected = decltype(policies);
+            simulate<Selected::coning_samples, typename Selected::earth_model, typename Selected::normalization_method,
+                typename Selected::coriolis_sum, typename Selected::sensor_errors>(scenario, steps, sink);
+        });
+    }
+}
+
+#endif // STRAPDOWN_H
@@ -0,0 +1,81 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+    // The calling thread takes jobs too
+    const unsigned extra = threads > 1 ? threads - 1 : 0;
+    for (unsigned i = 0; i < extra; ++i)
+    {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::size() const
+{
+    return static_cast<unsigned>(workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->count = count;
+        next = 0;
+        pending = static_cast<unsigned>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return pending == 0; });
+    this->task = nullptr;
+}
+
+void ThreadPool::work()
+{
+    std::uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+        }
+
+        drain();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --pending;
+        }
+        done.notify_one();
+    }
+}
+
+void ThreadPool::drain()
+{
+    for (std::size_t i = next++; i < count; i = next++)
+    {
+        (*task)(i);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for independent, index-addressed jobs
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Number of threads taking jobs, including the calling one
+    unsigned size() const;
+
+    // Runs task(i) for every i in [0, count) and blocks until all are done.
+    // Indices are handed out dynamically, so uneven jobs balance themselves.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)> &task);
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(std::size_t)> *task = nullptr;
+    std::size_t count = 0;
+    std::atomic<std::size_t> next { 0 };
+    std::uint64_t generation = 0;
+    unsigned pending = 0;
+    bool stopping = false;
+
+    void work();
+    void drain();
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,152 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include "NumCpp.hpp"
+#include "kalman.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Read-only view of a finished Trajectory. Copies share the same
+// reference-counted buffer, which outlives the Trajectory it came from.
+template <std::size_t Rows>
+class TrajectoryView
+{
+public:
+    TrajectoryView() = default;
+    TrajectoryView(std::shared_ptr<const std::vector<double>> data, std::size_t steps) : steps_(steps), data_(std::move(data)) {}
+
+    static constexpr std::size_t rows() { return Rows; }
+    std::size_t size() const { return steps_; }
+    bool empty() const { return !data_; }
+
+    double operator()(std::size_t row, std::size_t step) const { return (*data_)[step * Rows + row]; }
+
+    kalman::Vector<Rows> column(std::size_t step) const
+    {
+        kalman::Vector<Rows> result;
+        std::copy_n(data_->begin() + step * Rows, Rows, result.data.begin());
+        return result;
+    }
+
+    const double *data() const { return data_ ? data_->data() : nullptr; }
+
+private:
+    std::size_t steps_ = 0;
+    std::shared_ptr<const std::vector<double>> data_;
+};
+
+// State history sized up front and written in place, one column per step.
+// Storage is column-major, so each step is a contiguous Rows-sized block.
+// Copies are deep; view() shares the buffer instead.
+template <std::size_t Rows>
+class Trajectory
+{
+public:
+    Trajectory() = default;
+    explicit Trajectory(std::size_t steps) : steps_(steps), data_(std::make_shared<std::vector<double>>(Rows * steps, 0.)) {}
+
+    Trajectory(const Trajectory &other) : steps_(other.steps_), data_(other.copyData()) {}
+    // The moved-from history is left empty with no buffer, so moving never
+    // allocates; size() is 0 and view() and data() give empty results.
+    Trajectory(Trajectory &&other) noexcept : steps_(std::exchange(other.steps_, 0)), data_(std::move(other.data_)) {}
+    Trajectory &operator=(const Trajectory &other)
+    {
+        if (this != &other)
+        {
+            data_ = other.copyData();
+            steps_ = other.steps_;
+        }
+        return *this;
+    }
+    Trajectory &operator=(Trajectory &&other) noexcept
+    {
+        if (this != &other)
+        {
+            steps_ = std::exchange(other.steps_, 0);
+            data_ = std::move(other.data_);
+        }
+        return *this;
+    }
+
+    static constexpr std::size_t rows() { return Rows; }
+    std::size_t size() const { return steps_; }
+
+    double &operator()(std::size_t row, std::size_t step) { return (*data_)[step * Rows + row]; }
+    double operator()(std::size_t row, std::size_t step) const { return (*data_)[step * Rows + row]; }
+
+    kalman::Vector<Rows> column(std::size_t step) const
+    {
+        kalman::Vector<Rows> result;
+        std::copy_n(data_->begin() + step * Rows, Rows, result.data.begin());
+        return result;
+    }
+
+    void setColumn(std::size_t step, const kalman::Vector<Rows> &value)
+    {
+        std::copy_n(value.data.begin(), Rows, data_->begin() + step * Rows);
+    }
+
+    // 0 for an empty history
+    double max(std::size_t row) const
+    {
+        if (steps_ == 0)
+        {
+            return 0.;
+        }
+
+        double result = (*this)(row, 0);
+        for (std::size_t i = 1; i < steps_; ++i)
+        {
+            result = std::max(result, (*this)(row, i));
+        }
+        return result;
+    }
+
+    // Raw column-major buffer
+    const double *data() const { return data_ ? data_->data() : nullptr; }
+
+    // Shares the buffer without copying. Take views of finished histories only,
+    // later writes through this Trajectory would show through them.
+    TrajectoryView<Rows> view() const { return TrajectoryView<Rows>(data_, steps_); }
+
+    // Copy of a single component as a 1 x n NdArray
+    nc::NdArray<double> copyRow(std::size_t row) const
+    {
+        nc::NdArray<double> result(1, static_cast<nc::uint32>(steps_));
+        for (std::size_t i = 0; i < steps_; ++i)
+        {
+            result(0, static_cast<nc::int32>(i)) = (*this)(row, i);
+        }
+        return result;
+    }
+
+    // Copy of the whole history as a Rows x n NdArray, same layout the
+    // hstack-built arrays had. NdArray is row-major, so it cannot view the
+    // column-major buffer in that shape; use data() or view() to avoid the copy.
+    nc::NdArray<double> copyToNdArray() const
+    {
+        nc::NdArray<double> result(static_cast<nc::uint32>(Rows), static_cast<nc::uint32>(steps_));
+        for (std::size_t r = 0; r < Rows; ++r)
+        {
+            for (std::size_t i = 0; i < steps_; ++i)
+            {
+                result(static_cast<nc::int32>(r), static_cast<nc::int32>(i)) = (*this)(r, i);
+            }
+        }
+        return result;
+    }
+
+private:
+    std::shared_ptr<std::vector<double>> copyData() const
+    {
+        return data_ ? std::make_shared<std::vector<double>>(*data_) : nullptr;
+    }
+
+    std::size_t steps_ = 0;
+    std::shared_ptr<std::vector<double>> data_;
+};
+
+#endif // TRAJECTORY_H